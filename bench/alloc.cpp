@@ -0,0 +1,73 @@
+#include <iostream> // needed for printing the results
+#include <chrono> // needed for timing
+#include <cstdlib> // needed for std::malloc, std::free and std::aligned_alloc
+#include <new> // needed to replace the global allocation functions
+#include <atomic> // needed for the counters
+
+#include "matrix.h" // the Matrix class
+
+/**
+ * Counts heap allocations in a steady-state loop of matrix updates.
+ * After one warm-up round (which sizes the destination and the packing buffers) every iteration of
+ * `out = a + b`, `out += c`, `out *= 2`, `out -= c`, `out = a * b + c` and `multiplyInto(prod, a, b)` should allocate nothing.
+ * Usage: alloc.out [N] [iterations]   (defaults: N = 128, 1000 iterations); exits with 1 if the loop allocated
+ */
+
+// every global `new` goes through these so we can count them
+static std::atomic<size_t> allocations{0};
+static std::atomic<size_t> bytesAllocated{0};
+
+void* countedAlloc(size_t n, size_t align) {
+    allocations++;
+    bytesAllocated += n;
+    void* p = align <= alignof(std::max_align_t) ? std::malloc(n ? n : 1)
+                                                 : std::aligned_alloc(align, (n + align - 1) / align * align);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t n) { return countedAlloc(n, 0); }
+void* operator new[](size_t n) { return countedAlloc(n, 0); }
+void* operator new(size_t n, std::align_val_t a) { return countedAlloc(n, static_cast<size_t>(a)); }
+void* operator new[](size_t n, std::align_val_t a) { return countedAlloc(n, static_cast<size_t>(a)); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+template<typename T>
+void step(const Matrix<T>& a, const Matrix<T>& b, const Matrix<T>& c, Matrix<T>& out, Matrix<T>& prod) {
+    out = a + b;
+    out += c;
+    out *= T(2);
+    out -= c;
+    out = a * b + c;
+    multiplyInto(prod, a, b);
+    multiplyInto(prod, a, c, true);
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 128;
+    size_t iterations = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 1000;
+
+    Matrix<double> a(n, n), b(n, n), c(n, n), out(1, 1), prod(1, 1);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) { a(i, j) = double(i + j); b(i, j) = double(i) - double(j); c(i, j) = 1; }
+
+    step(a, b, c, out, prod); // warm up: sizes `out`, `prod` and the packing buffers
+
+    size_t before = allocations.load(), bytesBefore = bytesAllocated.load();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t it = 0; it < iterations; it++) step(a, b, c, out, prod);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t count = allocations.load() - before, bytes = bytesAllocated.load() - bytesBefore;
+
+    std::cout << "N=" << n << "\titerations " << iterations
+              << "\tallocations " << count << "\tbytes " << bytes
+              << "\t" << seconds / iterations * 1e6 << " us/iteration\n";
+    return count == 0 ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+#include <iostream> // needed for printing the results
+#include <cstdlib> // needed for std::atoi
+#include <random> // needed to fill the matrices
+#include <string> // needed for std::string
+#include <vector> // needed for the matrix lists
+
+#include "benchmark.h" // the harness
+#include "matrixBatched.h" // the batch being measured
+
+/**
+ * Benchmark of `BatchedMatrices<T>` against one `Matrix<T>` operation per pair on lots of tiny matrices.
+ * Every run adds and multiplies `count` pairs of NxN matrices and takes the trace of each, once pair by pair with
+ * `multiplyInto` into a reused result and once with the batched operations, which vectorize across matrices.
+ * Usage: batched.out [count]   (default 100000)
+ */
+
+template<typename T, size_t N>
+void compare(const std::string& name, size_t count) {
+    std::mt19937 rng(42);
+    std::vector<Matrix<T>> singleA, singleB;
+    BatchedMatrices<T> batchA(N, N), batchB(N, N);
+    for (size_t m = 0; m < count; m++) {
+        Matrix<T> a(N, N), b(N, N);
+        bench::fill(a, rng);
+        bench::fill(b, rng);
+        batchA.push(a);
+        batchB.push(b);
+        singleA.push_back(std::move(a));
+        singleB.push_back(std::move(b));
+    }
+
+    Matrix<T> single(N, N); // reused so only the per-pair overhead is measured, not allocation
+    std::vector<T> singleTraces(count);
+    BatchedMatrices<T> batch(N, N);
+    std::vector<T> batchTraces;
+    bench::Options options;
+    options.warmup = 1;
+
+    bench::Stats singleAdd = bench::measure([&] {
+        for (size_t m = 0; m < count; m++) { single = singleA[m]; single += singleB[m]; singleTraces[m] = single.trace(); }
+    }, options);
+    bench::Stats batchAdd = bench::measure([&] { batch = batchA + batchB; batchTraces = batch.traces(); }, options);
+    bench::Stats singleMul = bench::measure([&] {
+        for (size_t m = 0; m < count; m++) { multiplyInto(single, singleA[m], singleB[m]); singleTraces[m] = single.trace(); }
+    }, options);
+    bench::Stats batchMul = bench::measure([&] { multiplyInto(batch, batchA, batchB); batchTraces = batch.traces(); }, options);
+
+    bool same = singleTraces == batchTraces;
+    for (size_t m = 0; m < count && same; m++) {
+        Matrix<T> expected(singleA[m] * singleB[m]), got = batch.get(m);
+        for (size_t i = 0; i < N && same; i++)
+            for (size_t j = 0; j < N && same; j++) same = expected(i, j) == got(i, j);
+    }
+
+    auto perMatrix = [&](const bench::Stats& s) { return s.median / static_cast<double>(count) * 1e9; };
+    std::cout << name << "\t" << N << "x" << N
+              << "\tadd+trace " << perMatrix(singleAdd) << " ns -> " << perMatrix(batchAdd) << " ns"
+              << "\tmultiply+trace " << perMatrix(singleMul) << " ns -> " << perMatrix(batchMul) << " ns"
+              << "\t" << (same ? "same" : "differs") << '\n';
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 100000;
+    compare<int, 2>("int", count);
+    compare<int, 4>("int", count);
+    compare<int, 8>("int", count);
+    compare<double, 4>("double", count);
+    return 0;
+}
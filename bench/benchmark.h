@@ -0,0 +1,175 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <cstdio> // needed for std::snprintf
+#include <chrono> // needed for timing
+#include <vector> // needed to keep every sample
+#include <string> // needed for std::string
+#include <fstream> // needed for the results file
+#include <iostream> // needed for the table on stdout
+#include <algorithm> // needed for std::sort
+#include <cmath> // needed for std::ceil
+#include <ctime> // needed to stamp the results file
+#include <stdexcept> // needed for exceptions
+#include <random> // needed to fill the matrices
+
+#include "matrix.h" // the matrices the helpers fill and multiply
+#include "matrixSimd.h" // to record which instruction set the kernels ran with
+#include "threadPool.h" // to record how many threads the kernels ran with
+
+/**
+ * A small benchmark harness: warms a function up, runs it until it has enough samples, and reports the median and p99 time
+ * together with GFLOP/s and GB/s computed from the work the caller says one run does.
+ * Every result is printed as a line of a table on stdout and, if a results file was given, appended to it as a tab separated row
+ * so two runs can be compared with `diff` or loaded into a spreadsheet.
+ * It also has the inputs and the reference result the benchmarks share (`fill` and `naiveMultiply`)
+ */
+namespace bench {
+
+    /**
+     * Fills a matrix with random whole numbers from -8 to 8, so integer products do not overflow and floating point
+     * products are exact whatever order a kernel adds them in (so every kernel can be checked with `==`)
+     * @param m the matrix to fill
+     * @param rng where the values come from; seed it so runs are repeatable
+     */
+    template<typename T>
+    void fill(Matrix<T>& m, std::mt19937& rng) {
+        std::uniform_int_distribution<int> dist(-8, 8);
+        for (size_t i = 0; i < m.numRows(); i++)
+            for (size_t j = 0; j < m.numCols(); j++) m(i, j) = static_cast<T>(dist(rng));
+    }
+
+    /**
+     * c = a * b with the textbook i-j-k loop on the same flat storage; what `operator*` used to do, and the reference
+     * the kernels are checked against
+     * @param c the result; must already be a.numRows() x b.numCols()
+     */
+    template<typename T>
+    void naiveMultiply(const Matrix<T>& a, const Matrix<T>& b, Matrix<T>& c) {
+        const size_t n = a.numRows(), m = b.numCols(), k = a.numCols();
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < m; j++) {
+                T sum{};
+                for (size_t p = 0; p < k; p++) sum += a(i, p) * b(p, j);
+                c(i, j) = sum;
+            }
+        }
+    }
+
+    // how long and how often to run each measurement
+    struct Options {
+        int warmup = 2; // runs thrown away before measuring (page faults, cold caches, starting the pool)
+        int minReps = 5; // always take at least this many samples
+        int maxReps = 1000; // and never more than this many
+        double minSeconds = 0.2; // keep sampling until this much time has been measured (or `maxReps` is hit)
+
+        // for work where one run already takes long (big files, whole sweeps): no warmup and exactly `reps` samples
+        static Options few(int reps = 3) {
+            Options options;
+            options.warmup = 0;
+            options.minReps = options.maxReps = reps;
+            options.minSeconds = 0;
+            return options;
+        }
+    };
+
+    // the timing of one benchmark
+    struct Stats {
+        size_t reps = 0; // samples taken
+        double median = 0; // seconds
+        double p99 = 0; // seconds; the 99th percentile (nearest rank), i.e. the max for fewer than 100 samples
+        double min = 0; // seconds
+    };
+
+    /**
+     * Runs `fn` as `options` says and gives back its timing
+     * @param fn the work to time; called with no arguments
+     * @param options how long and how often to run it
+     * @return Stats the median, p99 and min time of one run
+     */
+    template<class F>
+    Stats measure(F&& fn, const Options& options = Options()) {
+        for (int i = 0; i < options.warmup; i++) fn();
+
+        std::vector<double> samples;
+        double total = 0;
+        while ((static_cast<int>(samples.size()) < options.minReps || total < options.minSeconds) &&
+               static_cast<int>(samples.size()) < options.maxReps) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            samples.push_back(s);
+            total += s;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        Stats stats;
+        stats.reps = samples.size();
+        stats.min = samples.front();
+        stats.median = samples.size() % 2 ? samples[samples.size() / 2]
+                                          : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+        stats.p99 = samples[static_cast<size_t>(std::ceil(0.99 * static_cast<double>(samples.size()))) - 1];
+        return stats;
+    }
+
+    /**
+     * Collects results; prints each one as it comes in and writes them all to a results file
+     */
+    class Reporter {
+    public:
+        /**
+         * @brief Construct a new Reporter
+         * @param path the results file (replaced); empty for stdout only
+         */
+        explicit Reporter(const std::string& path = "") {
+            if (!path.empty()) {
+                file.open(path, std::ios::trunc);
+                if (!file.is_open()) throw std::runtime_error("Could not open file: " + path);
+                std::time_t now = std::time(nullptr);
+                char date[32];
+                std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+                file << "# date " << date << "\tthreads " << ThreadPool::instance().size()
+                     << "\tsimd " << levelName(simd::level()) << '\n';
+                file << "op\ttype\tn\treps\tmedian_ns\tp99_ns\tmin_ns\tgflops\tgbytes_per_s\n";
+            }
+            std::printf("%-18s %-7s %6s %6s %12s %12s %10s %10s\n", "op", "type", "n", "reps", "median(us)", "p99(us)", "GFLOP/s", "GB/s");
+        }
+
+        /**
+         * Records one result
+         * @param op what was measured (e.g. "add")
+         * @param type the element type (e.g. "double")
+         * @param n the matrix size
+         * @param stats the timing
+         * @param flops floating point (or integer) operations one run does; 0 if that does not apply
+         * @param bytes bytes one run reads and writes
+         */
+        void add(const std::string& op, const std::string& type, size_t n, const Stats& stats, double flops, double bytes) {
+            const double gflops = flops / stats.median * 1e-9;
+            const double gbytes = bytes / stats.median * 1e-9;
+            char gflopsText[32] = "-";
+            if (flops > 0) std::snprintf(gflopsText, sizeof(gflopsText), "%.3f", gflops);
+            std::printf("%-18s %-7s %6zu %6zu %12.3f %12.3f %10s %10.3f\n", op.c_str(), type.c_str(), n, stats.reps,
+                        stats.median * 1e6, stats.p99 * 1e6, gflopsText, gbytes);
+            std::fflush(stdout);
+
+            if (file.is_open()) {
+                file << op << '\t' << type << '\t' << n << '\t' << stats.reps << '\t'
+                     << static_cast<long long>(stats.median * 1e9) << '\t' << static_cast<long long>(stats.p99 * 1e9) << '\t'
+                     << static_cast<long long>(stats.min * 1e9) << '\t' << (flops > 0 ? gflops : 0) << '\t' << gbytes << '\n';
+                file.flush(); // so a run that is cut short still leaves its results behind
+            }
+        }
+
+    private:
+        static const char* levelName(simd::Level level) {
+            switch (level) {
+                case simd::Level::AVX512: return "avx512";
+                case simd::Level::AVX2: return "avx2";
+                default: return "scalar";
+            }
+        }
+
+        std::ofstream file; // the results file, if there is one
+    };
+}
@@ -0,0 +1,61 @@
+#include <iostream> // needed for printing the results
+#include <fstream> // needed to write the text file
+#include <cstdio> // needed for std::remove
+#include <cstdlib> // needed for std::atoi
+#include <string> // needed for std::string
+
+#include "benchmark.h" // the harness
+#include "matrixReader.h" // the text reader
+#include "matrixBinary.h" // the binary format
+
+/**
+ * Benchmark of loading matrices from the text format (`MatrixReader`) against mapping the binary format (`MappedMatrixFile`).
+ * Both sides take the trace of every matrix so the binary side actually touches its data (it is paged in lazily).
+ * Usage: binary.out [N] [count]   (default 1024 and 8)
+ */
+
+template<typename T>
+void run(const std::string& name, size_t n, size_t count) {
+    const std::string text = "/tmp/matrix_binary_bench_" + name + ".txt";
+    const std::string binary = "/tmp/matrix_binary_bench_" + name + ".bin";
+
+    Matrix<T> m(n, n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) m(i, j) = static_cast<T>((i * 31 + j * 17) % 1000);
+    {
+        std::ofstream out(text);
+        out << n << '\n';
+        for (size_t k = 0; k < count; k++) {
+            for (size_t i = 0; i < n; i++)
+                for (size_t j = 0; j < n; j++) out << m(i, j) << (j + 1 < n ? ' ' : '\n');
+        }
+        BinaryMatrixWriter<T> writer(binary, n, n);
+        for (size_t k = 0; k < count; k++) writer.write(m);
+    }
+
+    volatile T sink{}; // keeps the loads from being optimized away
+    double tText = bench::measure([&] {
+        MatrixReader<T> reader(text);
+        for (size_t k = 0; k < count; k++) sink = reader.readMatrix().trace();
+    }, bench::Options::few()).median;
+    double tBinary = bench::measure([&] {
+        MappedMatrixFile<T> matrices(binary);
+        for (size_t k = 0; k < matrices.size(); k++) sink = matrices[k].trace();
+    }, bench::Options::few()).median;
+    (void)sink;
+
+    std::cout << name << "\t" << count << " x " << n << "x" << n
+              << "\ttext " << tText * 1e3 << " ms"
+              << "\tbinary (mmap) " << tBinary * 1e3 << " ms"
+              << "\tspeedup " << tText / tBinary << "x\n";
+    std::remove(text.c_str());
+    std::remove(binary.c_str());
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 1024;
+    size_t count = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 8;
+    run<int>("int", n, count);
+    run<double>("double", n, count);
+    return 0;
+}
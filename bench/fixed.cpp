@@ -0,0 +1,62 @@
+#include <iostream> // needed for printing the results
+#include <cstdlib> // needed for std::atoi
+#include <random> // needed to fill the matrices
+#include <string> // needed for std::string
+#include <vector> // needed for the matrix lists
+
+#include "benchmark.h" // the harness
+#include "matrix.h" // both the dynamic and the fixed size Matrix
+
+/**
+ * Benchmark of the fixed size `Matrix<T, N, N>` against the dynamic `Matrix<T>` on lots of tiny matrices.
+ * Every run adds and multiplies `count` pairs of NxN matrices (like the 4x4s in `matrices.txt`) and keeps the results,
+ * so it measures the per-matrix overhead (allocation, size checks, kernel setup) that dominates at this size.
+ * Usage: fixed.out [count]   (default 100000)
+ */
+
+template<typename T, size_t N>
+void compare(const std::string& name, size_t count) {
+    std::mt19937 rng(42);
+    std::vector<Matrix<T>> dynamicA, dynamicB;
+    std::vector<Matrix<T, N, N>> fixedA(count), fixedB(count);
+    for (size_t m = 0; m < count; m++) {
+        Matrix<T> a(N, N), b(N, N);
+        bench::fill(a, rng);
+        bench::fill(b, rng);
+        fixedA[m] = Matrix<T, N, N>(a);
+        fixedB[m] = Matrix<T, N, N>(b);
+        dynamicA.push_back(std::move(a));
+        dynamicB.push_back(std::move(b));
+    }
+
+    std::vector<Matrix<T>> dynamicOut(count, Matrix<T>(N, N));
+    std::vector<Matrix<T, N, N>> fixedOut(count);
+    bench::Options options;
+    options.warmup = 1;
+
+    // a fresh result per pair, the way the assignment code uses `a + b` and `a * b`
+    bench::Stats dynamicAdd = bench::measure([&] { for (size_t m = 0; m < count; m++) dynamicOut[m] = Matrix<T>(dynamicA[m] + dynamicB[m]); }, options);
+    bench::Stats fixedAdd = bench::measure([&] { for (size_t m = 0; m < count; m++) fixedOut[m] = fixedA[m] + fixedB[m]; }, options);
+    bench::Stats dynamicMul = bench::measure([&] { for (size_t m = 0; m < count; m++) dynamicOut[m] = Matrix<T>(dynamicA[m] * dynamicB[m]); }, options);
+    bench::Stats fixedMul = bench::measure([&] { for (size_t m = 0; m < count; m++) fixedOut[m] = fixedA[m] * fixedB[m]; }, options);
+
+    bool same = true;
+    for (size_t m = 0; m < count && same; m++)
+        for (size_t i = 0; i < N && same; i++)
+            for (size_t j = 0; j < N && same; j++) same = dynamicOut[m](i, j) == fixedOut[m](i, j);
+
+    auto perMatrix = [&](const bench::Stats& s) { return s.median / static_cast<double>(count) * 1e9; };
+    std::cout << name << "\t" << N << "x" << N
+              << "\tadd " << perMatrix(dynamicAdd) << " ns -> " << perMatrix(fixedAdd) << " ns"
+              << "\tmultiply " << perMatrix(dynamicMul) << " ns -> " << perMatrix(fixedMul) << " ns"
+              << "\t" << (same ? "same" : "differs") << '\n';
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 100000;
+    compare<int, 2>("int", count);
+    compare<int, 4>("int", count);
+    compare<int, 8>("int", count);
+    compare<double, 4>("double", count);
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <iostream> // needed for printing the results
+#include <cstdlib> // needed for std::atoi
+#include <random> // needed to fill the matrices
+#include <string> // needed for std::string
+
+#include "benchmark.h" // the harness
+#include "matrix.h" // the Matrix class and its blocked multiply
+
+/**
+ * Benchmark comparing `Matrix<T>::operator*` (the blocked kernel) against the textbook i-j-k loop it replaced.
+ * Usage: gemm.out [maxN]   sweeps N = 64, 128, ... up to maxN (default 1024; past that the naive loop makes the sweep take many minutes)
+ */
+
+template<typename T>
+void sweep(const std::string& name, size_t maxN) {
+    std::mt19937 rng(42);
+    bench::Options options = bench::Options::few(); // at least 3 runs, more for the small sizes until 0.2s is measured
+    options.maxReps = 100;
+    options.minSeconds = 0.2;
+    for (size_t n = 64; n <= maxN; n *= 2) {
+        Matrix<T> a(n, n), b(n, n), naive(n, n);
+        bench::fill(a, rng);
+        bench::fill(b, rng);
+
+        const double flops = 2.0 * n * n * n;
+        double tBlocked = bench::measure([&] { Matrix<T> c = a * b; }, options).median;
+        double tNaive = bench::measure([&] { bench::naiveMultiply(a, b, naive); }, options).median;
+
+        // the blocked kernel adds in a different order, which only matters for floating point
+        Matrix<T> blocked = a * b;
+        bool same = true;
+        for (size_t i = 0; i < n && same; i++)
+            for (size_t j = 0; j < n && same; j++) same = blocked(i, j) == naive(i, j);
+
+        std::cout << name << "\tN=" << n
+                  << "\tnaive " << flops / tNaive * 1e-9 << " GFLOP/s"
+                  << "\tblocked " << flops / tBlocked * 1e-9 << " GFLOP/s"
+                  << "\tspeedup " << tNaive / tBlocked << "x"
+                  << "\t" << (same ? "exact" : "differs (rounding)") << '\n';
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t maxN = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 1024;
+    sweep<int>("int", maxN);
+    sweep<float>("float", maxN);
+    sweep<double>("double", maxN);
+}
@@ -0,0 +1,86 @@
+#include <iostream> // needed for printing the results
+#include <fstream> // needed to write the input file
+#include <sstream> // needed for the old reader
+#include <cstdio> // needed for std::remove
+#include <cstdlib> // needed for std::atoi
+#include <string> // needed for std::string
+#include <random> // needed for the matrix values
+
+#include "benchmark.h" // the harness
+#include "matrixReader.h" // the reader being measured
+
+/**
+ * Benchmark of `MatrixReader` against the `getline`/`istringstream` reader it replaced.
+ * Writes a text file of `count` N x N matrices in the `matrices.txt` format, reads it back with both and reports MB/s.
+ * Usage: parse.out [N] [count]   (default 1024 and 8, i.e. about 50 MB of `int` text and 100 MB of `double`)
+ */
+
+// the reader as it was before: one `std::string` per line and `operator>>` per value
+template<typename T>
+Matrix<T> oldRead(std::ifstream& file, size_t n) {
+    Matrix<T> result(n, n);
+    std::string line;
+    for (size_t i = 0; i < n; i++) {
+        if (!std::getline(file, line)) throw std::runtime_error("Unexpected end of file while reading matrix data.");
+        std::istringstream iss(line);
+        for (size_t j = 0; j < n; j++) {
+            T value;
+            if (!(iss >> value)) throw std::runtime_error("Invalid matrix data format.");
+            result[i][j] = value;
+        }
+    }
+    return result;
+}
+
+// writes the input file and gives back its size in bytes
+template<typename T>
+size_t writeInput(const std::string& path, size_t n, size_t count) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(-100000, 100000);
+    std::ofstream out(path);
+    out << n << '\n';
+    for (size_t m = 0; m < count; m++) {
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                if constexpr (std::is_floating_point_v<T>) out << dist(rng) / 97.0;
+                else out << dist(rng);
+                out << (j + 1 < n ? ' ' : '\n');
+            }
+        }
+    }
+    return static_cast<size_t>(out.tellp());
+}
+
+template<typename T>
+void run(const std::string& name, size_t n, size_t count) {
+    const std::string path = "/tmp/matrix_parse_bench_" + name + ".txt";
+    const double mb = writeInput<T>(path, n, count) * 1e-6;
+
+    volatile T sink{}; // keeps the reads from being optimized away
+    double tOld = bench::measure([&] {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        size_t size = std::stoul(line);
+        for (size_t m = 0; m < count; m++) sink = oldRead<T>(file, size)(0, 0);
+    }, bench::Options::few()).median;
+    double tNew = bench::measure([&] {
+        MatrixReader<T> reader(path);
+        for (size_t m = 0; m < count; m++) sink = reader.readMatrix()(0, 0);
+    }, bench::Options::few()).median;
+    (void)sink;
+
+    std::cout << name << "\t" << mb << " MB"
+              << "\tgetline/istringstream " << mb / tOld << " MB/s"
+              << "\tMatrixReader " << mb / tNew << " MB/s"
+              << "\tspeedup " << tOld / tNew << "x\n";
+    std::remove(path.c_str());
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 1024;
+    size_t count = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 8;
+    run<int>("int", n, count);
+    run<double>("double", n, count);
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <iostream> // needed for printing the results
+#include <cstdlib> // needed for std::atoi
+#include <random> // needed to fill the matrices
+#include <string> // needed for std::string
+#include <sstream> // needed to collect the pipeline's output
+#include <fstream> // needed to write the input files
+#include <filesystem> // needed for the temporary directory
+#include <sys/resource.h> // needed for getrusage (peak memory)
+
+#include "benchmark.h" // the shared inputs
+#include "matrixPipeline.h" // the batch mode being measured
+
+/**
+ * Benchmark and regression check of the batch mode of `main` (matrixPipeline.h). Writes `count` pairs of NxN matrices as a
+ * text file and as a binary file, runs the same ops over both with 1, 2, 4 and 8 threads, and prints the throughput of each run.
+ * The products are big enough to be split over the pool from inside the pipeline's own pool tasks.
+ * Before that, a file of one pair of 1024x1024 matrices is run with the default batch size, which has to size its batches to the
+ * file and the matrices rather than hold a fixed number of them.
+ * Usage: pipeline.out [count] [N]   (default 64 and 160)
+ * Exits with 1 unless every run prints byte for byte the same output and the big matrices stay under 256 MB, so `make check` fails
+ */
+
+// writes `2 * count` random NxN matrices to `textFile` and the same ones to `binaryFile`
+void writeInput(const std::string& textFile, const std::string& binaryFile, size_t count, size_t n) {
+    std::mt19937 rng(42);
+    std::ofstream text(textFile);
+    MatrixWriter writer(text, MatrixLayout::Plain);
+    BinaryMatrixWriter<int> binary(binaryFile, n, n);
+    writer.writeSize(n);
+    Matrix<int> m(n, n);
+    for (size_t k = 0; k < 2 * count; k++) {
+        bench::fill(m, rng);
+        writer.write(m);
+        binary.write(m);
+    }
+}
+
+// the most memory the process has held so far, in MB
+double peakMB() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss) / 1024; // Linux reports KB
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 64;
+    size_t n = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 160;
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::string textFile = (dir / "matrix_pipeline_bench.txt").string();
+    const std::string binaryFile = (dir / "matrix_pipeline_bench.bin").string();
+    bool ok = true;
+
+    { // first, while nothing else has grown the process: 8 MB of matrices must not turn into gigabytes of batches
+        const size_t bigN = 1024;
+        writeInput(textFile, binaryFile, 1, bigN);
+        pipeline::Options options;
+        options.ops = pipeline::parseOps("add,trace");
+        std::string expected;
+        for (const std::string& input : {textFile, binaryFile}) {
+            options.input = input;
+            std::ostringstream out;
+            pipeline::Report report = pipeline::run<int>(options, &out);
+            if (expected.empty()) expected = out.str();
+            const bool same = out.str() == expected, small = peakMB() < 256;
+            ok = ok && same && small;
+            std::cout << (input == textFile ? "text  " : "binary") << "\tN=" << bigN << "\t1 pair\tdefault batch\t"
+                      << report.seconds * 1e3 << " ms\tpeak " << peakMB() << " MB" << (small ? "" : " (TOO MUCH)") << '\t'
+                      << (same ? "same output" : "DIFFERENT output") << '\n';
+        }
+    }
+
+    writeInput(textFile, binaryFile, count, n);
+    pipeline::Options options;
+    options.ops = pipeline::parseOps("add,multiply,trace,swapRows:0:1,update:0:0:7");
+    options.batchSize = 32;
+
+    const size_t defaultThreads = ThreadPool::instance().size();
+    std::string expected;
+    for (const std::string& input : {textFile, binaryFile}) {
+        options.input = input;
+        for (size_t threads : {size_t(1), size_t(2), size_t(4), size_t(8)}) {
+            ThreadPool::setThreadCount(threads);
+            std::ostringstream out;
+            pipeline::Report report = pipeline::run<int>(options, &out);
+            if (expected.empty()) expected = out.str(); // the text file with one thread is the reference
+            const bool same = out.str() == expected;
+            ok = ok && same;
+            std::cout << (input == textFile ? "text  " : "binary") << "\tN=" << n << "\t" << count << " pairs\t" << threads
+                      << " threads\t" << report.seconds * 1e3 << " ms\t" << report.matrices / report.seconds << " matrices/s\t"
+                      << (same ? "same output" : "DIFFERENT output") << '\n';
+        }
+    }
+    ThreadPool::setThreadCount(defaultThreads);
+    std::filesystem::remove(textFile);
+    std::filesystem::remove(binaryFile);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+#include <iostream> // needed for printing the results
+#include <chrono> // needed for timing
+#include <cstdlib> // needed for std::atoi
+#include <thread> // needed for the request threads
+#include <vector> // needed for the thread list
+
+#include "matrix.h" // the Matrix class
+#include "matrixPool.h" // the pool being measured
+
+/**
+ * Benchmark of matrix temporaries under concurrent load: `threads` threads each run `iterations` "requests" that build
+ * `a + b`, `a * b` and a copy as fresh matrices, first with every buffer from the global heap and then with one `MatrixPool`
+ * per thread made the default with `MatrixResourceScope`. Prints the time of both and the pools' hit rate.
+ * Usage: pool.out [N] [threads] [iterations]   (default 16, the hardware thread count and 20000)
+ */
+
+template<typename F>
+double timeThreads(size_t threads, F&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; t++) workers.emplace_back([&, t] { fn(t); });
+    for (auto& w : workers) w.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 16;
+    size_t threads = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+    size_t iterations = argc > 3 ? static_cast<size_t>(std::atoi(argv[3])) : 20000;
+
+    Matrix<int> a(n, n), b(n, n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            a(i, j) = static_cast<int>(i + j);
+            b(i, j) = static_cast<int>(i * j % 7);
+        }
+
+    std::vector<long> sinks(threads); // keeps the work from being optimized away
+    auto request = [&](size_t t) {
+        Matrix<int> sum = a + b;
+        Matrix<int> product = a * b;
+        Matrix<int> copy(product);
+        sinks[t] += sum(0, 0) + copy(n - 1, n - 1);
+    };
+
+    double heap = timeThreads(threads, [&](size_t t) {
+        for (size_t k = 0; k < iterations; k++) request(t);
+    });
+
+    std::vector<MatrixPool> pools(threads);
+    double pooled = timeThreads(threads, [&](size_t t) {
+        MatrixResourceScope scope(&pools[t]);
+        for (size_t k = 0; k < iterations; k++) request(t);
+    });
+
+    MatrixPool::Stats total;
+    for (const MatrixPool& p : pools) {
+        MatrixPool::Stats s = p.stats();
+        total.allocations += s.allocations;
+        total.hits += s.hits;
+        total.bytesRequested += s.bytesRequested;
+        total.bytesHeld += s.bytesHeld;
+    }
+
+    std::cout << n << "x" << n << "\t" << threads << " threads\theap " << heap * 1e3 << " ms -> pool " << pooled * 1e3 << " ms"
+              << "\t" << total.allocations << " allocations, hit rate " << total.hitRate() * 100 << "%, "
+              << total.bytesRequested << " bytes requested, " << total.bytesHeld << " bytes held\n";
+    return 0;
+}
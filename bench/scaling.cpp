@@ -0,0 +1,39 @@
+#include <iostream> // needed for printing the results
+#include <cstdlib> // needed for std::atoi
+#include <vector> // needed for the list of thread counts
+
+#include "benchmark.h" // the harness
+#include "matrix.h" // the Matrix class and the thread pool
+
+/**
+ * Thread scaling report: times `operator*` and `operator+` with 1, 2, 4, ... up to the max thread count
+ * and prints the speedup and parallel efficiency against the single thread run.
+ * Usage: scaling.out [maxThreads] [N]   (defaults: one per core, N = 1024)
+ */
+
+int main(int argc, char** argv) {
+    size_t maxThreads = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : ThreadPool::defaultThreadCount();
+    size_t n = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 1024;
+
+    Matrix<double> a(n, n), b(n, n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) { a(i, j) = double(i % 7) - 3; b(i, j) = double(j % 5) - 2; }
+
+    double base[2] = {0, 0}; // single thread times for multiply and add
+    std::vector<size_t> counts;
+    for (size_t t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(maxThreads); // always end on the full count even when it is not a power of two
+
+    std::cout << "threads\tmultiply GFLOP/s\tspeedup\tefficiency\tadd GB/s\tspeedup\tefficiency\t(N=" << n << ")\n";
+    for (size_t t : counts) {
+        ThreadPool::setThreadCount(t);
+        double tMul = bench::measure([&] { Matrix<double> c = a * b; }, bench::Options::few()).median;
+        double tAdd = bench::measure([&] { Matrix<double> c = a + b; }, bench::Options::few()).median;
+        if (t == 1) { base[0] = tMul; base[1] = tAdd; }
+
+        std::cout << t
+                  << '\t' << 2.0 * n * n * n / tMul * 1e-9 << '\t' << base[0] / tMul << "x\t" << base[0] / tMul / t
+                  << '\t' << 3.0 * n * n * sizeof(double) / tAdd * 1e-9 << '\t' << base[1] / tAdd << "x\t" << base[1] / tAdd / t
+                  << '\n';
+    }
+}
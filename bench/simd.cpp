@@ -0,0 +1,51 @@
+#include <iostream> // needed for printing the results
+#include <cstdlib> // needed for std::atoi
+#include <string> // needed for std::string
+
+#include "benchmark.h" // the harness
+#include "matrix.h" // the Matrix class and the simd kernels
+
+/**
+ * Benchmark of the elementwise kernels at every instruction set level the host supports.
+ * Reports memory bandwidth (GB/s) of the add kernel on its own (`operator+` also pays for allocating the result)
+ * and the time per `trace()`/`secondaryDiagonalSum()`.
+ * Usage: simd.out [N]   uses N x N matrices (default 4096, i.e. 64 MiB of `int` per matrix so it does not fit in cache)
+ */
+
+const char* levelName(simd::Level level) {
+    switch (level) {
+        case simd::Level::AVX512: return "avx512";
+        case simd::Level::AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+template<typename T>
+void run(const std::string& name, size_t n) {
+    Matrix<T> a(n, n), b(n, n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) { a(i, j) = static_cast<T>(i + j); b(i, j) = static_cast<T>(i); }
+    Matrix<T> c = a + b; // the destination is touched once before timing so page faults are not counted
+
+    const double bytes = 3.0 * n * n * sizeof(T); // two reads and one write per cell
+    for (simd::Level level : {simd::Level::Scalar, simd::Level::AVX2, simd::Level::AVX512}) {
+        simd::setLevel(level);
+        if (simd::level() != level) continue; // host does not have it
+
+        double tAdd = bench::measure([&] { simd::add(a.ptr(), b.ptr(), c.ptr(), n * n); }).median;
+        volatile T sink{};
+        double tTrace = bench::measure([&] { sink = a.trace() + a.secondaryDiagonalSum(); }).median;
+        (void)sink;
+        std::cout << name << "\tN=" << n << '\t' << levelName(level)
+                  << "\tadd " << bytes / tAdd * 1e-9 << " GB/s"
+                  << "\tdiagonals " << tTrace * 1e6 << " us\n";
+    }
+    simd::setLevel(simd::Level::AVX512); // back to the best the host has
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 4096;
+    run<int>("int", n);
+    run<float>("float", n);
+    run<double>("double", n);
+}
@@ -0,0 +1,57 @@
+#include <iostream> // needed for printing the results
+#include <cstdlib> // needed for std::atoi
+#include <random> // needed to fill the matrices
+#include <string> // needed for std::string
+
+#include "benchmark.h" // the harness
+#include "sparseMatrix.h" // the CSR matrix and the dense one
+
+/**
+ * Benchmark of the CSR matrix against the dense one over a sweep of densities.
+ * For each density it reports the memory both take and the time of `sparse * dense` against `dense * dense`,
+ * so it shows where (roughly) the sparse format stops paying off. The products are checked against each other.
+ * Usage: sparse.out [N]   (default 1024)
+ */
+
+template<typename T>
+void sweep(const std::string& name, size_t n) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> values(1, 8);
+    std::uniform_real_distribution<double> coin(0, 1);
+    bench::Options options;
+    options.warmup = 1;
+    options.minReps = 3;
+
+    Matrix<T> b(n, n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) b(i, j) = static_cast<T>(values(rng));
+
+    for (double density : {0.001, 0.01, 0.05, 0.1, 0.25, 0.5}) {
+        Matrix<T> a(n, n); // all zero apart from about `density` of the cells
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++) if (coin(rng) < density) a(i, j) = static_cast<T>(values(rng));
+        SparseMatrix<T> s(a);
+
+        Matrix<T> dense(n, n), sparse(n, n);
+        bench::Stats tDense = bench::measure([&] { dense = a * b; }, options);
+        bench::Stats tSparse = bench::measure([&] { sparse = s * b; }, options);
+
+        bool same = true;
+        for (size_t i = 0; i < n && same; i++)
+            for (size_t j = 0; j < n && same; j++) same = dense(i, j) == sparse(i, j);
+
+        std::cout << name << "\tN=" << n << "\tdensity " << density << "\tnonzeros " << s.nonZeros()
+                  << "\tmemory " << s.memoryBytes() / 1024 << " KiB vs " << n * n * sizeof(T) / 1024 << " KiB"
+                  << "\tsparse*dense " << tSparse.median * 1e3 << " ms"
+                  << "\tdense*dense " << tDense.median * 1e3 << " ms"
+                  << "\tspeedup " << tDense.median / tSparse.median << "x"
+                  << "\t" << (same ? "same" : "differs") << '\n';
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 1024;
+    sweep<int>("int", n);
+    sweep<double>("double", n);
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include <iostream> // needed for printing the results
+#include <cstdlib> // needed for std::atoi
+#include <random> // needed to fill the matrices
+#include <string> // needed for std::string
+
+#include "benchmark.h" // the harness
+#include "matrix.h" // the Matrix class and both multiply kernels
+
+/**
+ * Benchmark of the Strassen-Winograd multiply against the blocked kernel, to find the crossover size.
+ * For each N it times `MultiplyPolicy::Standard` and `MultiplyPolicy::Strassen` (with one level of recursion per halving
+ * above the cutoff) and checks that integer results are identical. Odd sizes are included to show the cost of peeling.
+ * Usage: strassen.out [maxN] [cutoff]   (default 1024 and the current `StrassenConfig<T>::cutoff`)
+ */
+
+template<typename T>
+void sweep(const std::string& name, size_t maxN, size_t cutoff) {
+    std::mt19937 rng(42);
+    StrassenConfig<T>::cutoff = cutoff;
+    bench::Options options;
+    options.warmup = 1;
+    options.minReps = 3;
+    options.minSeconds = 0.5;
+
+    for (size_t base = 256; base <= maxN; base *= 2) {
+        for (size_t n : {base, base + 1}) {
+            Matrix<T> a(n, n), b(n, n), standard(n, n), fast(n, n);
+            bench::fill(a, rng);
+            bench::fill(b, rng);
+
+            Matrix<T>::multiplyPolicy = MultiplyPolicy::Standard;
+            bench::Stats tStandard = bench::measure([&] { multiplyInto(standard, a, b); }, options);
+            Matrix<T>::multiplyPolicy = MultiplyPolicy::Strassen;
+            bench::Stats tStrassen = bench::measure([&] { multiplyInto(fast, a, b); }, options);
+            Matrix<T>::multiplyPolicy = MultiplyPolicy::Standard;
+
+            bool same = true;
+            for (size_t i = 0; i < n && same; i++)
+                for (size_t j = 0; j < n && same; j++) same = standard(i, j) == fast(i, j);
+
+            std::cout << name << "\tN=" << n << "\tcutoff " << cutoff
+                      << "\tstandard " << tStandard.median * 1e3 << " ms"
+                      << "\tstrassen " << tStrassen.median * 1e3 << " ms"
+                      << "\tspeedup " << tStandard.median / tStrassen.median << "x"
+                      << "\t" << (same ? "exact" : "differs (rounding)") << '\n';
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t maxN = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 1024;
+    sweep<int>("int", maxN, argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : StrassenConfig<int>::cutoff);
+    sweep<long>("long", maxN, argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : StrassenConfig<long>::cutoff);
+    sweep<double>("double", maxN, argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : StrassenConfig<double>::cutoff);
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <iostream> // needed for printing the results
+#include <fstream> // needed to write the input file
+#include <cstdio> // needed for std::remove
+#include <cstdlib> // needed for std::atoi
+#include <string> // needed for std::string
+
+#include "benchmark.h" // the harness
+#include "matrixReader.h" // the readers being measured
+
+/**
+ * Benchmark of a read-then-compute pipeline over a file holding many matrices:
+ * `readMatrix()` one at a time, `MatrixStream` (reusing one buffer) and `BatchReader` (parsing on a background thread).
+ * The compute step is `trace(m * m)` so there is real work for the parsing to overlap with.
+ * Usage: stream.out [N] [count] [batch]   (default 64, 4096 and 256)
+ */
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 64;
+    size_t count = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 4096;
+    size_t batch = argc > 3 ? static_cast<size_t>(std::atoi(argv[3])) : 256;
+
+    const std::string path = "/tmp/matrix_stream_bench.txt";
+    {
+        std::ofstream out(path);
+        out << n << '\n';
+        for (size_t k = 0; k < count; k++)
+            for (size_t i = 0; i < n; i++)
+                for (size_t j = 0; j < n; j++) out << (k + i * 7 + j * 3) % 100 << (j + 1 < n ? ' ' : '\n');
+    }
+
+    volatile long sink = 0; // keeps the work from being optimized away
+    Matrix<int> product(n, n); // reused by every variant so only the reading differs
+    double tReader = bench::measure([&] {
+        MatrixReader<int> reader(path);
+        long total = 0;
+        for (size_t k = 0; k < count; k++) {
+            Matrix<int> m = reader.readMatrix();
+            multiplyInto(product, m, m);
+            total += product.trace();
+        }
+        sink = total;
+    }, bench::Options::few()).median;
+    double tStream = bench::measure([&] {
+        MatrixStream<int> stream(path);
+        long total = 0;
+        for (const Matrix<int>& m : stream) {
+            multiplyInto(product, m, m);
+            total += product.trace();
+        }
+        sink = total;
+    }, bench::Options::few()).median;
+    double tBatch = bench::measure([&] {
+        BatchReader<int> reader(path, batch);
+        long total = 0;
+        while (auto matrices = reader.next()) {
+            for (const Matrix<int>& m : matrices) {
+                multiplyInto(product, m, m);
+                total += product.trace();
+            }
+        }
+        sink = total;
+    }, bench::Options::few()).median;
+    (void)sink;
+
+    std::cout << count << " x " << n << "x" << n << " int"
+              << "\treadMatrix " << count / tReader << " matrices/s"
+              << "\tMatrixStream " << count / tStream << " matrices/s"
+              << "\tBatchReader(" << batch << ") " << count / tBatch << " matrices/s\n";
+    std::remove(path.c_str());
+    return 0;
+}
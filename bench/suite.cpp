@@ -0,0 +1,134 @@
+#include <iostream> // needed for printing the results
+#include <fstream> // needed for the text file `read` parses
+#include <sstream> // needed to split the command line lists
+#include <streambuf> // needed for the output sink `write` uses
+#include <cstdio> // needed for std::remove
+#include <cstdlib> // needed for std::atoi
+#include <string> // needed for std::string
+#include <vector> // needed for the size/type/op lists
+#include <random> // needed to fill the matrices
+#include <algorithm> // needed for std::find
+
+#include "benchmark.h" // the harness
+#include "matrixReader.h" // the Matrix class and the reader
+
+/**
+ * Benchmark of every `Matrix<T>` operation over a sweep of sizes and element types.
+ * Prints a table and writes the same results as tab separated rows to a file so runs can be diffed over time.
+ * `make bench` runs this and writes `bench_output.txt`.
+ * Usage: suite.out [--out FILE] [--sizes 64,256,1024] [--types int,long,float,double] [--ops add,multiply,...]
+ *   ops: add sub scale multiply trace secondaryDiagonal swapRows swapCols read write
+ */
+
+// throws away everything written to it, so `write` measures formatting and not the disk
+class NullBuffer : public std::streambuf {
+protected:
+    std::streamsize xsputn(const char*, std::streamsize n) override {
+        written += static_cast<size_t>(n);
+        return n;
+    }
+    int_type overflow(int_type c) override {
+        written++;
+        return traits_type::not_eof(c);
+    }
+
+public:
+    size_t written = 0; // bytes written so far
+};
+
+// splits "a,b,c" into its parts
+std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> parts;
+    std::istringstream in(list);
+    for (std::string part; std::getline(in, part, ',');) if (!part.empty()) parts.push_back(part);
+    return parts;
+}
+
+template<typename T>
+void run(bench::Reporter& reporter, const std::string& type, const std::vector<size_t>& sizes, const std::vector<std::string>& ops) {
+    auto wanted = [&](const std::string& op) { return std::find(ops.begin(), ops.end(), op) != ops.end(); };
+    std::mt19937 rng(42);
+    volatile T sink{}; // keeps results from being optimized away
+
+    for (size_t n : sizes) {
+        Matrix<T> a(n, n), b(n, n), c(n, n);
+        bench::fill(a, rng);
+        bench::fill(b, rng);
+        const double cells = static_cast<double>(n) * n, size = sizeof(T);
+
+        if (wanted("add")) reporter.add("add", type, n, bench::measure([&] { c = a + b; }), cells, 3 * cells * size);
+        if (wanted("sub")) reporter.add("sub", type, n, bench::measure([&] { c = a - b; }), cells, 3 * cells * size);
+        if (wanted("scale")) reporter.add("scale", type, n, bench::measure([&] { c = a * T(3); }), cells, 2 * cells * size);
+        if (wanted("multiply"))
+            reporter.add("multiply", type, n, bench::measure([&] { c = a * b; }), 2 * cells * n, 3 * cells * size);
+        if (wanted("trace"))
+            reporter.add("trace", type, n, bench::measure([&] { sink = a.trace(); }), static_cast<double>(n), n * size);
+        if (wanted("secondaryDiagonal"))
+            reporter.add("secondaryDiagonal", type, n, bench::measure([&] { sink = a.secondaryDiagonalSum(); }),
+                         static_cast<double>(n), n * size);
+        if (wanted("swapRows"))
+            reporter.add("swapRows", type, n, bench::measure([&] { a.swapRows(0, n - 1); }), 0, 4 * n * size);
+        if (wanted("swapCols"))
+            reporter.add("swapCols", type, n, bench::measure([&] { a.swapCols(0, n - 1); }), 0, 4 * n * size);
+
+        if (wanted("write")) {
+            NullBuffer sinkBuffer;
+            std::ostream out(&sinkBuffer);
+            MatrixWriter(out).write(a); // once up front to find out how much text one run makes
+            const double bytes = static_cast<double>(sinkBuffer.written);
+            reporter.add("write", type, n, bench::measure([&] { MatrixWriter(out).write(a); }), 0, bytes);
+        }
+        if (wanted("read")) {
+            const std::string path = "/tmp/matrix_suite_bench_" + type + ".txt";
+            {
+                std::ofstream file(path);
+                MatrixWriter writer(file, MatrixLayout::Plain);
+                writer.writeSize(n);
+                writer.write(a);
+            }
+            std::ifstream size(path, std::ios::binary | std::ios::ate);
+            const double bytes = static_cast<double>(size.tellg());
+            reporter.add("read", type, n, bench::measure([&] {
+                MatrixReader<T> reader(path);
+                sink = reader.readMatrix()(0, 0);
+            }), 0, bytes);
+            std::remove(path.c_str());
+        }
+    }
+    (void)sink;
+}
+
+int main(int argc, char** argv) {
+    std::string out;
+    std::vector<size_t> sizes = {64, 256, 1024};
+    std::vector<std::string> types = {"int", "long", "float", "double"};
+    std::vector<std::string> ops = {"add", "sub", "scale", "multiply", "trace", "secondaryDiagonal", "swapRows", "swapCols", "read", "write"};
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i], value = argv[i + 1];
+        if (flag == "--out") out = value;
+        else if (flag == "--sizes") {
+            sizes.clear();
+            for (const std::string& s : split(value)) sizes.push_back(static_cast<size_t>(std::atoi(s.c_str())));
+        }
+        else if (flag == "--types") types = split(value);
+        else if (flag == "--ops") ops = split(value);
+        else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    bench::Reporter reporter(out);
+    for (const std::string& type : types) {
+        if (type == "int") run<int>(reporter, type, sizes, ops);
+        else if (type == "long") run<long>(reporter, type, sizes, ops);
+        else if (type == "float") run<float>(reporter, type, sizes, ops);
+        else if (type == "double") run<double>(reporter, type, sizes, ops);
+        else {
+            std::cerr << "Unknown type: " << type << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
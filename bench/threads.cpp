@@ -0,0 +1,71 @@
+#include <iostream> // needed for printing the results
+#include <cstdlib> // needed for std::atoi
+#include <random> // needed to fill the matrices
+#include <string> // needed for std::string
+#include <vector> // needed for the matrix lists
+#include <algorithm> // needed for std::max
+
+#include "benchmark.h" // the harness
+#include "matrix.h" // the Matrix class and its multiply kernels
+
+/**
+ * Checks that products computed inside pool tasks are the same for every thread count, and times them.
+ * Every run multiplies `count` pairs of NxN matrices with one `parallelFor` chunk per pair, so each product is big enough to be
+ * split over the pool from inside a pool task, while the thread that waits for it runs other pairs meanwhile.
+ * The same is done with `MultiplyPolicy::Strassen` on an odd size with a cutoff that leaves the blocked multiplies at the
+ * bottom of the recursion big enough to split too, so the quadrant sums, the peeling and the base cases all run nested.
+ * Usage: threads.out [count] [N]   (default 32 and 160; Strassen uses count / 4 pairs of 385x385 with a cutoff of 200)
+ * Exits with 1 if any result differs from `bench::naiveMultiply`, so `make check` fails
+ */
+
+template<typename T>
+bool check(const std::string& name, size_t count, size_t n, MultiplyPolicy policy = MultiplyPolicy::Standard) {
+    std::mt19937 rng(42);
+    std::vector<Matrix<T>> a(count, Matrix<T>(n, n)), b(count, Matrix<T>(n, n)), expected(count, Matrix<T>(n, n));
+    for (size_t p = 0; p < count; p++) {
+        bench::fill(a[p], rng);
+        bench::fill(b[p], rng);
+        bench::naiveMultiply(a[p], b[p], expected[p]);
+    }
+
+    const size_t defaultThreads = ThreadPool::instance().size();
+    Matrix<T>::multiplyPolicy = policy;
+    bool allSame = true;
+    for (size_t threads : {size_t(1), size_t(2), size_t(4), size_t(8)}) {
+        ThreadPool::setThreadCount(threads);
+        std::vector<Matrix<T>> results(count, Matrix<T>(n, n));
+        bench::Stats stats = bench::measure([&] {
+            parallelFor(0, count, 1, [&](size_t lo, size_t hi) {
+                for (size_t p = lo; p < hi; p++) multiplyInto(results[p], a[p], b[p]);
+            });
+        }, bench::Options::few());
+
+        size_t wrong = 0;
+        for (size_t p = 0; p < count; p++) {
+            bool same = true;
+            for (size_t i = 0; i < n && same; i++)
+                for (size_t j = 0; j < n && same; j++) same = results[p](i, j) == expected[p](i, j);
+            wrong += !same;
+        }
+        allSame = allSame && wrong == 0;
+
+        std::cout << name << "\tN=" << n << "\t" << count << " pairs\t" << threads << " threads\t"
+                  << stats.median * 1e3 << " ms\t" << (wrong ? std::to_string(wrong) + " wrong" : "exact") << '\n';
+    }
+    ThreadPool::setThreadCount(defaultThreads);
+    Matrix<T>::multiplyPolicy = MultiplyPolicy::Standard;
+    return allSame;
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 32;
+    size_t n = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 160;
+    bool ok = check<int>("int", count, n);
+    ok = check<double>("double", count, n) && ok;
+
+    StrassenConfig<int>::cutoff = StrassenConfig<double>::cutoff = 200; // 385 peels to 384, which splits into 192s
+    const size_t strassenCount = std::max<size_t>(1, count / 4);
+    ok = check<int>("int strassen", strassenCount, 385, MultiplyPolicy::Strassen) && ok;
+    ok = check<double>("double strassen", strassenCount, 385, MultiplyPolicy::Strassen) && ok;
+    return ok ? 0 : 1;
+}
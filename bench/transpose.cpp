@@ -0,0 +1,51 @@
+#include <iostream> // needed for printing the results
+#include <cstdlib> // needed for std::atoi
+#include <random> // needed to fill the matrix and pick the swaps
+#include <vector> // needed for the swap list
+#include <utility> // needed for std::pair
+
+#include "benchmark.h" // the harness
+#include "matrix.h" // the matrix class
+#include "matrixPermutation.h" // the lazy row/col permutation
+
+/**
+ * Benchmark of transposing and of repeated col swaps on an NxN matrix:
+ *   - naive transpose (read rows, write cols) against the cache-oblivious `transposeInto`, and square `transposeInPlace`
+ *   - `swaps` random `Matrix<T>::swapCols` against the same swaps on a `PermutedMatrix` followed by one `materialize()`
+ * Usage: transpose.out [N] [swaps]   (default 2048 and 1000)
+ */
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 2048;
+    size_t swaps = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 1000;
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(-100, 100);
+    Matrix<double> a(n, n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) a(i, j) = dist(rng);
+
+    bench::Options options;
+    Matrix<double> out(n, n);
+    bench::Stats naive = bench::measure([&] {
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++) out(j, i) = a(i, j);
+    }, options);
+    bench::Stats oblivious = bench::measure([&] { transposeInto(out, a); }, options);
+    Matrix<double> b = a;
+    bench::Stats inPlace = bench::measure([&] { b.transposeInPlace(); }, options);
+
+    std::uniform_int_distribution<size_t> pick(0, n - 1);
+    std::vector<std::pair<size_t, size_t>> order(swaps);
+    for (auto& s : order) s = {pick(rng), pick(rng)};
+    bench::Stats eager = bench::measure([&] { for (auto& s : order) b.swapCols(s.first, s.second); }, options);
+    PermutedMatrix<double> p(a);
+    bench::Stats lazySwaps = bench::measure([&] { for (auto& s : order) p.swapCols(s.first, s.second); }, options);
+    bench::Stats lazyMaterialize = bench::measure([&] { p.materializeInto(out); }, options);
+
+    std::cout << n << "x" << n
+              << "\ttranspose naive " << naive.median * 1e3 << " ms -> cache-oblivious " << oblivious.median * 1e3
+              << " ms (in place " << inPlace.median * 1e3 << " ms)"
+              << "\n" << swaps << " swapCols: eager " << eager.median * 1e3 << " ms -> lazy "
+              << lazySwaps.median * 1e3 << " ms + one materialize " << lazyMaterialize.median * 1e3 << " ms\n";
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <iostream> // needed for printing the results
+#include <fstream> // needed for the output files
+#include <cstdio> // needed for std::remove
+#include <cstdlib> // needed for std::atoi
+#include <string> // needed for std::string
+
+#include "benchmark.h" // the harness
+#include "matrix.h" // the Matrix class and `MatrixWriter`
+#include "matrixBinary.h" // the binary writer
+
+/**
+ * Benchmark of writing a matrix to a file: the old per-element `os << m(i, j) << "\t"` loop against `MatrixWriter`
+ * (pretty and plain layouts) and `BinaryMatrixWriter`. Reports the time and how fast the output was produced.
+ * Usage: write.out [N]   (default 2048)
+ */
+
+// the way `operator<<` used to print: one stream insertion per element
+template<typename T>
+void oldPrint(std::ostream& os, const Matrix<T>& m) {
+    for (size_t i = 0; i < m.numRows(); i++) {
+        os << "|\t";
+        for (size_t j = 0; j < m.numCols(); j++) os << m(i, j) << "\t";
+        os << "|\n";
+    }
+}
+
+// times `fn(path)` writing a file and prints the time and MB/s of the file it made
+template<typename F>
+void report(const std::string& label, const std::string& path, F&& fn) {
+    double t = bench::measure([&] { fn(path); }, bench::Options::few()).median;
+    std::ifstream size(path, std::ios::binary | std::ios::ate);
+    const double mb = static_cast<double>(size.tellg()) * 1e-6;
+    std::cout << "\t" << label << " " << t * 1e3 << " ms (" << mb / t << " MB/s)";
+}
+
+template<typename T>
+void run(const std::string& name, size_t n) {
+    Matrix<T> m(n, n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) m(i, j) = static_cast<T>((static_cast<double>(i) * 31 - static_cast<double>(j) * 17) / 7);
+
+    const std::string path = "/tmp/matrix_write_bench_" + name;
+    std::cout << name << "\tN=" << n;
+    report("operator<< (old)", path, [&](const std::string& p) {
+        std::ofstream file(p);
+        oldPrint(file, m);
+    });
+    report("pretty", path, [&](const std::string& p) {
+        std::ofstream file(p);
+        MatrixWriter(file, MatrixLayout::Pretty).write(m);
+    });
+    report("plain", path, [&](const std::string& p) {
+        std::ofstream file(p);
+        MatrixWriter writer(file, MatrixLayout::Plain);
+        writer.writeSize(n);
+        writer.write(m);
+    });
+    report("binary", path + ".bin", [&](const std::string& p) { BinaryMatrixWriter<T>(p, n, n).write(m); });
+    std::cout << '\n';
+    std::remove(path.c_str());
+    std::remove((path + ".bin").c_str());
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 2048;
+    run<int>("int", n);
+    run<double>("double", n);
+    return 0;
+}
@@ -2,11 +2,13 @@
 #include <string> // needed for std::string
 
 #include "matrixReader.h" // include the MatrixReader class
+#include "matrixPipeline.h" // the non-interactive batch mode
 
 /**
  * Namespace that holds all the functions for the assignment
  * They were uncomfortably precise in their requirements so I put them all in here to interface with my matrix class
  *      I want the matrix class to be reusable and not tied to a specific assignment
+ * Each one takes a `Matrix<T, R, C>`, so it works with the usual runtime sized `Matrix<T>` and with a fixed size one like `Matrix<int, 4, 4>`
  */
 namespace assignmentFunction {
 
@@ -16,8 +18,8 @@ namespace assignmentFunction {
      * @param a const Matrix reference to the first matrix to be printed
      * @param b const Matrix reference to the second matrix to be printed
      */
-    template<typename T>
-    void print(const Matrix<T>& a, const Matrix<T>& b) {
+    template<typename T, size_t R, size_t C>
+    void print(const Matrix<T, R, C>& a, const Matrix<T, R, C>& b) {
         // print the two matrices with labels
         std::cout << "Matrix 1:\n" << a << "\nMatrix 2:\n" << b << '\n';
     }
@@ -28,8 +30,8 @@ namespace assignmentFunction {
      * @param a const Matrix reference to the first matrix to be added
      * @param b const Matrix reference to the second matrix to be added
      */
-    template<typename T>
-    void add(const Matrix<T>& a, const Matrix<T>& b) {
+    template<typename T, size_t R, size_t C>
+    void add(const Matrix<T, R, C>& a, const Matrix<T, R, C>& b) {
         // print the sum of the two matrices
         // uses the overloaded + operator and the overloaded << operator for printing
         std::cout << "add:\n" << a + b << '\n';
@@ -41,8 +43,8 @@ namespace assignmentFunction {
      * @param a const Matrix reference to the first matrix to be multiplied
      * @param b const Matrix reference to the second matrix to be multiplied
      */
-    template<typename T>
-    void multiply(const Matrix<T>& a, const Matrix<T>& b) {
+    template<typename T, size_t R, size_t C>
+    void multiply(const Matrix<T, R, C>& a, const Matrix<T, R, C>& b) {
         // print the product of the two matrices
         // uses the overloaded * operator and the overloaded << operator for printing
         std::cout << "multiply:\n" << a * b << '\n';
@@ -53,8 +55,8 @@ namespace assignmentFunction {
      * @tparam T type of the matrix elements
      * @param a const Matrix reference to the matrix whose diagonals will be summed
      */
-    template<typename T>
-    void trace(const Matrix<T>& a) {
+    template<typename T, size_t R, size_t C>
+    void trace(const Matrix<T, R, C>& a) {
         // print the sums of the main and secondary diagonals
 
         std::cout << "Main Diagonal:" << a.trace() // print the sum of the main diagonal
@@ -70,8 +72,8 @@ namespace assignmentFunction {
      * @param row2 size_t index of the second row to be swapped
      */
     // we want to use a reference here since we are modifying the matrix and dont want to make a copy
-    template<typename T>
-    void swapRows(Matrix<T>& a, size_t row1, size_t row2) {
+    template<typename T, size_t R, size_t C>
+    void swapRows(Matrix<T, R, C>& a, size_t row1, size_t row2) {
         // check that the row indices are in bounds
         if (!a.inRowBounds(row1) || !a.inRowBounds(row2)) {
             // if not, print error
@@ -91,8 +93,8 @@ namespace assignmentFunction {
      * @param col1 size_t index of the first column to be swapped
      * @param col2 size_t index of the second column to be swapped
      */
-    template<typename T>
-    void swapCols(Matrix<T>& a, size_t col1, size_t col2) {
+    template<typename T, size_t R, size_t C>
+    void swapCols(Matrix<T, R, C>& a, size_t col1, size_t col2) {
         // we want to use a reference for Matrix<T> here since we are modifying the matrix and dont want to make a copy
 
         // check that the column indices are in bounds
@@ -115,8 +117,8 @@ namespace assignmentFunction {
      * @param col size_t index of the column of the element to be updated
      * @param value the new value to be set at the specified position
      */
-    template<typename T>
-    void updateElement(Matrix<T>& a, size_t row, size_t col, const T& value) {
+    template<typename T, size_t R, size_t C>
+    void updateElement(Matrix<T, R, C>& a, size_t row, size_t col, const T& value) {
         // we want to use a reference for Matrix<T> here since we are modifying the matrix and dont want to make a copy
 
         // check that the row and column indices are in bounds
@@ -131,7 +133,11 @@ namespace assignmentFunction {
 };
 
 // required main function entry point for C/C++ programs
-int main() {
+// with no arguments it runs the assignment interactively; with arguments (e.g. `--batch file --ops add,trace`) it runs the batch mode
+int main(int argc, char** argv) {
+    profile::reportAtExit(); // prints where the time went when built with `make PROFILE=1`; does nothing otherwise
+    if (argc > 1) return pipeline::main(argc, argv); // see matrixPipeline.h for the options
+
     std::string filename{}; // string to hold the filename
     std::cout << "Enter the matrix file name: "; // prompt user for file name
     std::cin >> filename; // read the filename from user input
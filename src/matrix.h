@@ -1,39 +1,88 @@
 #pragma once // header guard
 
 #include <cstddef> // needed for `size_t`
-#include <vector> // needed for `std::vector` which we use to make the matrix
+#include <vector> // needed for `std::vector` which we use to store the matrix
 #include <iostream> // needed to both print and to get interface with the `<<` operator
 #include <initializer_list> // needed for the initializer list constructor
 #include <utility> // needed for std::swap
 #include <stdexcept> // needed for throwing errors
+#include <type_traits> // needed for std::type_identity
+
+#include "matrixAllocator.h" // aligned allocator for the matrix storage
+#include "matrixView.h" // row/col/submatrix views over the matrix storage
+#include "matrixGemm.h" // blocked multiply kernel used by `operator*`
+#include "matrixStrassen.h" // the opt-in Strassen-Winograd multiply
+#include "matrixTranspose.h" // cache-oblivious transpose kernels
+#include "matrixSimd.h" // vectorized elementwise kernels
+#include "threadPool.h" // splits big elementwise ops over threads
+#include "matrixWriter.h" // fast text output used by `operator<<`
+#include "matrixProfile.h" // opt-in timing of the hot paths
+
+template<class Derived> class MatrixExpr; // the lazily evaluated arithmetic results; see `matrixExpr.h`
+
+// the "size" of a dimension that is only known at runtime; `Matrix<T>` is short for `Matrix<T, dynamicSize, dynamicSize>`
+inline constexpr size_t dynamicSize = static_cast<size_t>(-1);
+
+// `Matrix<T>` has its dimensions picked at runtime (below); `Matrix<T, R, C>` has them fixed in its type (see `matrixFixed.h`)
+template<class T, size_t R = dynamicSize, size_t C = dynamicSize> class Matrix;
 
 /**
  * The matrix class with many matrix operations defined; uses operator overloading
+ * The cells are stored row-major in a single contiguous, aligned buffer so cell (i, j) lives at `i * cols + j`
  * @tparam T the type of the matrix, can be almost anything as long as it has standard operators defined (should probably be a standard number type however)
  * @author Jack Williamson
  * @date 10-27-2025
  */
 template<class T>
-class Matrix {
+class Matrix<T, dynamicSize, dynamicSize> {
     // the default for a class is private so we dont need to put the private header here
-    typedef std::vector<T> row_t; // a typedef so that the vector<T> can be shorter and have a more descriptive name
-    // equiv `std::vector<std::vector<T>>`
-    typedef std::vector<row_t> mat_t; // typedef of the double vector, even shorter and more descriptive
+    // one flat buffer for the whole matrix instead of a vector per row; a single allocation and no hopping between rows
+    typedef std::vector<T, AlignedAllocator<T>> buffer_t;
 
 public:
+    typedef StridedSpan<T> row_t; // a row (or column) view into the matrix; returned by `operator[]`
+    typedef StridedSpan<const T> const_row_t; // read-only version of `row_t`
+    typedef MatrixView<T> view_t; // a view of the whole matrix (or a block of it)
+    typedef MatrixView<const T> const_view_t; // read-only version of `view_t`
+    typedef T value_type; // the element type; lets the expression templates find `T`
+    typedef AlignedAllocator<T> allocator_type; // where the buffer comes from; also takes a `std::pmr::memory_resource*`
+
+    // which algorithm `operator*`, `*=` and `multiplyInto` use for this element type, e.g.
+    // `Matrix<int>::multiplyPolicy = MultiplyPolicy::Strassen;` (see `matrixStrassen.h`); can be changed at runtime
+    static inline MultiplyPolicy multiplyPolicy = MultiplyPolicy::Standard;
 
     /**
      * @brief Construct a new (empty) Matrix object
      * @param _rows the number of rows to the matrix
      * @param _cols the number of cols to the matrix
+     * @param alloc where the buffer comes from, e.g. `&pool` for a `MatrixPool` (matrixPool.h);
+     *              defaults to this thread's `currentMatrixResource()` (the global heap unless a `MatrixResourceScope` is active)
      */
-    Matrix(int _rows, int _cols)
+    Matrix(int _rows, int _cols, const allocator_type& alloc = defaultAllocator())
       : rows(_rows), // init the rows; counting starts at 1
         cols(_cols), // init the cols; counting starts at 1
-        // init the data vectors
-        // init the mat_t vector with size of `_rows` and default init of:
-        //  row_t vector with size of `cols` and `T` with default initlization
-        data(_rows, row_t(_cols, T{})) {}
+        // init the buffer with room for every cell, each `T` with default initlization
+        data(static_cast<size_t>(_rows) * static_cast<size_t>(_cols), T{}, alloc) {}
+
+    /**
+     * copy constructor; the buffer is a single vector so copying it copies every cell.
+     * Like `std::pmr`, the copy does not share the allocator of `other`; it takes `alloc` (by default the current one)
+     * @param other the matrix to copy
+     * @param alloc where the copy's buffer comes from
+     */
+    Matrix(const Matrix& other) : Matrix(other, defaultAllocator()) {}
+    Matrix(const Matrix& other, const allocator_type& alloc)
+      : rows(other.rows), cols(other.cols), data(other.data, alloc) {}
+
+    /**
+     * move constructor; takes over the buffer of `other` instead of copying it, so returning a matrix by value is cheap
+     * @param other the matrix to move from; left as an empty 0x0 matrix
+     */
+    Matrix(Matrix&& other) noexcept
+      : rows(other.rows), cols(other.cols), data(std::move(other.data)) {
+        other.rows = 0; // the buffer is gone so the moved-from matrix is 0x0
+        other.cols = 0;
+    }
 
     /**
      * assignment operator
@@ -50,69 +99,103 @@ public:
     }
 
     /**
-     * Addition operator (+) => (Matrix<T> + Matrix<T>)
-     * Adds to matrices together and gives result
-     * @param other the matrix to be added to `this` one
-     * @return Matrix; new matrix which holds the sum
+     * move assignment operator; hands over the buffer instead of copying when both matrices use the same allocator.
+     * With different allocators (e.g. one from a `MatrixPool`) the cells are copied so each buffer stays with its own resource,
+     * which can allocate, so this is not `noexcept`
+     * @param other the matrix to move from; left as an empty 0x0 matrix
+     * @return Matrix& reference to `this` matrix after assignment
      */
-    Matrix operator+(const Matrix& other) const {
-        // Can only add matrices of the same size so we check that we can
-        if (rows != other.rows || cols != other.cols) {
-            // if we cannont then throw an error and tell user
-            throw std::invalid_argument("Matrix dimensions must match for addition.");
-        }
-
-        // the matrix which holds the sum of the added matrices
-        Matrix result(rows, cols);
-        for (size_t row = 0; row < rows; row++) { // loop through every row
-            for (size_t col = 0; col < cols; col++) { // loop through every col
-                result.data[row][col] = data[row][col] + other.data[row][col]; // add cells and assign them to the result
-            }
+    Matrix& operator=(Matrix&& other) {
+        if (this != &other) { // protect against self-assignment
+            rows = other.rows;
+            cols = other.cols;
+            data = std::move(other.data); // just hands over the pointer if the allocators match
+            other.rows = 0;
+            other.cols = 0;
+            other.data.clear(); // a moved-from vector is only "valid but unspecified"; make sure it matches 0x0
         }
-        return result; // return copy of result to user
+        return *this;
     }
 
     /**
-     * Multiplies to matrices together and returns their product
-     * @param other the matrix to be multiplied to `this` one
-     * @return Matrix new matrix which holds the product
+     * Builds a matrix from a matrix expression (e.g. `Matrix<int> c = a + b;`); this is where the expression is computed
+     * @tparam E the expression type; see `matrixExpr.h`
+     * @param expr the expression to evaluate
+     * @param alloc where the buffer comes from
      */
-    Matrix operator*(const Matrix& other) const {
-        // Matrix multiplication needs the left matrix cols to be equal to the right's row number
-        if (cols != other.rows) { // if the matrices are improperly sized for multiplication
-            // throw error to the user
-            throw std::invalid_argument("Matrix dimensions do not allow multiplication.");
-        }
+    template<class E>
+    Matrix(const MatrixExpr<E>& expr, const allocator_type& alloc = defaultAllocator())
+      : rows(expr.derived().numRows()),
+        cols(expr.derived().numCols()),
+        data(rows * cols, alloc) { // the cells are about to be written so they are not zeroed first
+        expr.derived().evaluateInto(data.data());
+    }
 
-        Matrix result(rows, other.cols); // make properly sized matrix
-        for (size_t i = 0; i < rows; i++) { // loop through every row of this
-            for (size_t j = 0; j < other.cols; j++) { // loop through every col of other
-                result.data[i][j] = T{}; // set the current index to be the default init
-                for (size_t k = 0; k < cols; k++) { // then loop through every col of this
-                    result.data[i][j] += data[i][k] * other.data[k][j]; // follow the matrix multiplication formula and store results
-                }
-            }
+    /**
+     * Assigns the result of a matrix expression (e.g. `c = a * b + c;`) straight into this matrix's buffer
+     * @tparam E the expression type; see `matrixExpr.h`
+     * @param expr the expression to evaluate
+     * @return Matrix& reference to `this` matrix after assignment
+     */
+    template<class E>
+    Matrix& operator=(const MatrixExpr<E>& expr) {
+        const E& e = expr.derived();
+        // e.g. `a = a * b`; the result cannot be written over an operand (or a view into this matrix) that is still needed
+        if (e.unsafeAlias(data.data(), data.data() + data.size())) {
+            Matrix result(e, data.get_allocator()); // same allocator so the buffers can be swapped
+            std::swap(rows, result.rows);
+            std::swap(cols, result.cols);
+            data.swap(result.data);
+            return *this;
         }
-        return result; // return copy of result to user
+        resize(e.numRows(), e.numCols()); // no-op when the size already matches, which is the usual case
+        e.evaluateInto(data.data());
+        return *this;
     }
 
+    /**
+     * In-place addition (Matrix<T> += Matrix<T>); reuses this matrix's buffer so nothing is allocated
+     * @param other the matrix (or expression, e.g. `c += a * b`) to add
+     * @return Matrix& reference to `this` matrix after the addition
+     */
+    Matrix& operator+=(const Matrix& other) { return *this = *this + other; }
+    template<class E>
+    Matrix& operator+=(const MatrixExpr<E>& other) { return *this = *this + other.derived(); }
+
+    /**
+     * In-place subtraction (Matrix<T> -= Matrix<T>); reuses this matrix's buffer so nothing is allocated
+     * @param other the matrix (or expression) to subtract
+     * @return Matrix& reference to `this` matrix after the subtraction
+     */
+    Matrix& operator-=(const Matrix& other) { return *this = *this - other; }
+    template<class E>
+    Matrix& operator-=(const MatrixExpr<E>& other) { return *this = *this - other.derived(); }
+
+    /**
+     * In-place scalar multiplication; every cell is multiplied by `scalar` without allocating
+     * @param scalar the value to multiply by
+     * @return Matrix& reference to `this` matrix after the multiplication
+     */
+    Matrix& operator*=(const T& scalar) { return *this = *this * scalar; }
+
+    /**
+     * In-place matrix multiplication (this = this * other).
+     * A product cannot be written over its own operand, so this needs one temporary buffer;
+     * use `multiplyInto` with a buffer you keep around to avoid that allocation in a loop
+     * @param other the matrix (or expression) to multiply by
+     * @return Matrix& reference to `this` matrix after the multiplication
+     */
+    Matrix& operator*=(const Matrix& other) { return *this = *this * other; }
+    template<class E>
+    Matrix& operator*=(const MatrixExpr<E>& other) { return *this = *this * other.derived(); }
+
     /**
      * Trace is the main diagonal sum (top left to bottom right)
      * @return T the sum of the main diagonal cells
      */
     T trace() const { // trace makes no change to the class so we can call it const so it can be used by const objects
-        // trace can only be done on a square matrix so we check that it is one
-        if (rows != cols) {
-            // if not throw an error
-            throw std::invalid_argument("Trace is only defined for square matrices.");
-        }
-
-        // the sum needs to be the matrix type since its the sum of all the elements
-        T sum{}; // default init it so its not undefined
-        for (size_t i = 0; i < rows; i++) { // loop through; we only need a single loop since we are just looping the diagonal
-            sum += data[i][i]; // add up all diagonal elements
-        }
-        return sum; // return sum to user
+        // the view does the square check and walks the diagonal in place
+        return view().trace();
     }
 
     /**
@@ -120,17 +203,8 @@ public:
      * @return T the sum of the secondary diagonal cells
      */
     T secondaryDiagonalSum() const {
-        // same as before; can only be preformed on a square matrix
-        if (rows != cols) {
-            // throw error if not
-            throw std::invalid_argument("Secondary diagonal sum is only defined for square matrices.");
-        }
-
-        // the sum needs to be the matrix type since its the sum of all the elements
-        T sum{}; // default init it so its not undefined
-        for (size_t i = 0; i < rows; i++) // loop through; we only need a single loop since we are just looping the diagonal
-            sum += data[i][(cols - 1) - i]; // add up all secondary diagonal elements; the `(cols - 1) - i` is the formula to find the oposite diagonal
-        return sum; // return sum
+        // same as before; the view checks the matrix is square and walks the secondary diagonal in place
+        return view().secondaryDiagonalSum();
     }
 
     /**
@@ -139,12 +213,10 @@ public:
      * @param row2 the index of the second row
      */
     void swapRows(size_t row1, size_t row2) {
-        // check if indices are in bound,  if not do nothing
-        if (inRowBounds(row1) || inRowBounds(row2)) return;
+        // check if indices are in bound, if not do nothing
+        if (!inRowBounds(row1) || !inRowBounds(row2)) return;
 
-        for (size_t j = 0; j < cols; j++) { // loop through every col
-            std::swap(data[row1][j], data[row2][j]); // swap the elements in the two rows; we use std::swap to make it easier
-        }
+        view().swapRows(row1, row2); // rows are contiguous so the view swaps them as two blocks of memory
     }
 
     // Swap matrix columns
@@ -156,34 +228,87 @@ public:
      */
     void swapCols(size_t col1, size_t col2) {
         // check if indices are in bound, if not do nothing
-        if (inColBounds(col1) || inColBounds(col2)) return;
+        if (!inColBounds(col1) || !inColBounds(col2)) return;
 
-        for (size_t i = 0; i < rows; i++) { // loop through every row
-            std::swap(data[i][col1], data[i][col2]); // swap the elements in the two columns; we use std::swap to make it easier
+        view().swapCols(col1, col2); // one element per row; the view splits tall matrices over threads
+    }
+
+    /**
+     * Transposes the matrix. A square matrix is transposed in place; any other shape needs one temporary buffer
+     * (use `transposeInto` with a matrix you keep around to avoid it, or `transposed()` to not copy at all)
+     */
+    void transposeInPlace() {
+        MATRIX_PROFILE_SCOPE(Transpose, 2 * rows * cols * sizeof(T));
+        if (rows == cols) {
+            transposition::square(data.data(), cols, rows);
+            return;
         }
+        buffer_t result(rows * cols, data.get_allocator());
+        transposition::copy(data.data(), cols, result.data(), rows, rows, cols);
+        data.swap(result);
+        std::swap(rows, cols);
     }
 
     /**
      * Access operator to get a specific row of the matrix; allows for double indexing like `matrix[row][col]`
      * @param row the row index to access
-     * @return row_t& reference to the specified row
+     * @return row_t view of the specified row; writes through the view change the matrix
      */
-    row_t& operator[](size_t row) {
-        // use at() to get bounds checking for "free"
-        return data.at(row);
+    row_t operator[](size_t row) {
+        // the view gives us the same bounds checking that `std::vector::at()` used to
+        return view()[row];
     }
 
     /**
      * Access operator to get a specific row of the matrix; allows for double indexing like `matrix[row][col]`.
      * This is the const version which is called on const Matrix objects 
      * @param row the row index to access
-     * @return const row_t& reference to the specified row
+     * @return const_row_t read-only view of the specified row
+     */
+    const_row_t operator[](size_t row) const {
+        // the view gives us the same bounds checking that `std::vector::at()` used to
+        return view()[row];
+    }
+
+    /**
+     * Unchecked element access; skips the bounds check and row view of `matrix[row][col]`
+     * @param row the row of the element
+     * @param col the col of the element
+     * @return T& reference to the element
+     */
+    T& operator()(size_t row, size_t col) { return data[row * cols + col]; }
+    const T& operator()(size_t row, size_t col) const { return data[row * cols + col]; }
+
+    // views over the matrix; none of these copy any data
+    view_t view() { return view_t(data.data(), rows, cols); }
+    const_view_t view() const { return const_view_t(data.data(), rows, cols); }
+    row_t row(size_t r) { return view().row(r); }
+    const_row_t row(size_t r) const { return view().row(r); }
+    row_t col(size_t c) { return view().col(c); }
+    const_row_t col(size_t c) const { return view().col(c); }
+    view_t submatrix(size_t row, size_t col, size_t nRows, size_t nCols) { return view().submatrix(row, col, nRows, nCols); }
+    const_view_t submatrix(size_t row, size_t col, size_t nRows, size_t nCols) const { return view().submatrix(row, col, nRows, nCols); }
+    TransposedView<T> transposed() { return view().transposed(); }
+    TransposedView<const T> transposed() const { return view().transposed(); }
+
+    /**
+     * Changes the shape of the matrix. The buffer only grows, so shrinking (or going back to an earlier size)
+     * never allocates; the cell values are unspecified afterwards unless the shape did not change
+     * @param _rows the new number of rows
+     * @param _cols the new number of cols
      */
-    const row_t& operator[](size_t row) const {
-        // use at() to get bounds checking for "free"
-        return data.at(row);
+    void resize(size_t _rows, size_t _cols) {
+        rows = _rows;
+        cols = _cols;
+        data.resize(_rows * _cols);
     }
 
+    size_t numRows() const { return rows; } // the number of rows in the matrix
+    size_t numCols() const { return cols; } // the number of cols in the matrix
+    allocator_type get_allocator() const { return data.get_allocator(); } // where the buffer comes from
+    T* ptr() { return data.data(); } // the raw (row-major) buffer
+    const T* ptr() const { return data.data(); }
+
     /**
      * Overloaded output stream operator for Matrix class so we can print it easily using `std::cout << matrix;`
      * This is a friend function so it can access private members of the class, but is not a member function itself
@@ -193,23 +318,113 @@ public:
      * @return std::ostream& reference to the output stream
      */
     friend std::ostream& operator<<(std::ostream& os, const Matrix& m) {
-        // we need to acess the private members of Matrix so we make this a friend function
-        for (size_t i = 0; i < m.rows; i++) { // loop through every row
-            os << "|\t"; // print left border; tabbed for formatting
-            for (size_t j = 0; j < m.cols; j++) { // loop through every col
-                os << m.data[i][j] << "\t"; // print the element followed by a tab for formatting
-            }
-            os << "|\n"; // print right border and newline
-        }
+        // each row is printed as `|\t` then every element followed by a tab, then `|` and a newline;
+        // `MatrixWriter` formats the whole matrix into one buffer and hands it to `os` in one go instead of element by element
+        MatrixWriter(os, MatrixLayout::Pretty).write(m.view());
         return os; // return the output stream
     }
 
     // helper functions to check if indices are in bounds
     // just checks if the given row/col is within the matrix bounds [0, rows) or [0, cols)
-    bool inRowBounds(size_t row) const { return row < rows && row >= 0; }
-    bool inColBounds(size_t col) const { return col < cols && col >= 0; }
+    // (`size_t` is unsigned so it can never be below 0)
+    bool inRowBounds(size_t row) const { return row < rows; }
+    bool inColBounds(size_t col) const { return col < cols; }
 
 private: // private members; cannot be accessed outside the class (except by friends)
+    // the allocator a matrix gets when none is given: this thread's `currentMatrixResource()`
+    static allocator_type defaultAllocator() { return allocator_type(currentMatrixResource()); }
+
     size_t rows, cols; // dimensions of the matrix
-    mat_t data; // the actual matrix data stored as a vector of vectors
-};
\ No newline at end of file
+    buffer_t data; // the actual matrix data stored row-major in one aligned buffer
+};
+
+/**
+ * Runs the multiply kernel `Matrix<T>::multiplyPolicy` picks: out (+)= a * b. Does no checks; the callers already have
+ * @param a the left matrix (or any view of one, e.g. a submatrix or a matrix in a `MappedMatrixFile`)
+ * @param b the right matrix (or any view of one)
+ * @param out the row-major `a.numRows()` x `b.numCols()` result; must not overlap `a` or `b`
+ * @param accumulate add the product to what is already in `out` instead of overwriting it
+ */
+template<class T>
+void multiplyKernel(MatrixView<const T> a, MatrixView<const T> b, T* out, bool accumulate) {
+    MATRIX_PROFILE_SCOPE(Multiply, (a.numRows() * a.numCols() + b.numRows() * b.numCols() + a.numRows() * b.numCols()) * sizeof(T));
+    const size_t n = a.numRows();
+    // Strassen only pays off on big square problems; everything else goes to the blocked kernel either way
+    if (Matrix<T>::multiplyPolicy == MultiplyPolicy::Strassen && n == a.numCols() && n == b.numCols() &&
+        n > StrassenConfig<T>::cutoff) {
+        strassen::multiply(a.data(), a.stride(), b.data(), b.stride(), out, n, n, accumulate);
+        return;
+    }
+    gemm::multiply(a.data(), a.stride(), b.data(), b.stride(), out, b.numCols(),
+                   a.numRows(), b.numCols(), a.numCols(), accumulate);
+}
+
+/**
+ * Multiplies `a` and `b` into a matrix the caller already owns (out = a * b, or out += a * b when `accumulate` is set).
+ * `out` is resized to fit, which only allocates if it has never been that big before, so calling this in a loop
+ * with the same `out` does not touch the heap
+ * @param out the destination; must not hold any of `a` or `b`
+ * @param a the left matrix (or any view of one, e.g. a matrix in a `MappedMatrixFile`, which is read in place)
+ * @param b the right matrix (or any view of one)
+ * @param accumulate add the product to what is already in `out` instead of overwriting it (`out` must already be the right size)
+ */
+template<class T>
+void multiplyInto(Matrix<T>& out, std::type_identity_t<MatrixView<const T>> a, std::type_identity_t<MatrixView<const T>> b,
+                  bool accumulate = false) { // `T` comes from `out` alone so mutable views convert too
+    // Matrix multiplication needs the left matrix cols to be equal to the right's row number
+    if (a.numCols() != b.numRows()) {
+        throw std::invalid_argument("Matrix dimensions do not allow multiplication.");
+    }
+    const T* begin = out.ptr();
+    const T* end = begin + out.numRows() * out.numCols();
+    if (a.overlaps(begin, end) || b.overlaps(begin, end)) { // the kernel would overwrite an operand it still has to read
+        throw std::invalid_argument("Output matrix of multiplyInto must not be one of its operands.");
+    }
+    if (accumulate && (out.numRows() != a.numRows() || out.numCols() != b.numCols())) {
+        throw std::invalid_argument("Matrix dimensions must match for addition.");
+    }
+    out.resize(a.numRows(), b.numCols());
+    multiplyKernel(a, b, out.ptr(), accumulate);
+}
+template<class T>
+void multiplyInto(Matrix<T>& out, const Matrix<T>& a, const Matrix<T>& b, bool accumulate = false) {
+    multiplyInto(out, a.view(), b.view(), accumulate);
+}
+
+/**
+ * Transposes `a` into a matrix the caller already owns (out = a^T) with the cache-oblivious kernel;
+ * like `multiplyInto` this only allocates if `out` has never been that big before
+ * @param out the destination; must not hold any of `a`
+ * @param a the matrix (or any view of one, e.g. a submatrix) to transpose
+ */
+template<class T>
+void transposeInto(Matrix<T>& out, MatrixView<const T> a) {
+    const T* begin = out.ptr();
+    if (a.data() >= begin && a.data() < begin + out.numRows() * out.numCols()) { // the kernel would overwrite cells it still has to read
+        throw std::invalid_argument("Output matrix of transposeInto must not be its operand.");
+    }
+    MATRIX_PROFILE_SCOPE(Transpose, 2 * a.numRows() * a.numCols() * sizeof(T));
+    out.resize(a.numCols(), a.numRows());
+    transposition::copy(a.data(), a.stride(), out.ptr(), a.numRows(), a.numRows(), a.numCols());
+}
+template<class T>
+void transposeInto(Matrix<T>& out, const Matrix<T>& a) { transposeInto(out, a.view()); }
+
+/**
+ * Copies the transpose of `a` into a new matrix; `a.transposed()` is the version that does not copy
+ * @param a the matrix (or any view of one) to transpose
+ * @return Matrix<T> a^T
+ */
+template<class T>
+Matrix<T> transpose(MatrixView<const T> a) {
+    Matrix<T> result(0, 0);
+    transposeInto(result, a);
+    return result;
+}
+template<class T>
+Matrix<T> transpose(const Matrix<T>& a) { return transpose(a.view()); }
+
+// the arithmetic operators (`+`, `-`, `*`) build expressions that are only computed when assigned to a Matrix
+#include "matrixExpr.h"
+// the fixed size `Matrix<T, R, C>` for small matrices
+#include "matrixFixed.h"
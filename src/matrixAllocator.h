@@ -0,0 +1,100 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <new> // needed for aligned `operator new`
+#include <utility> // needed for std::forward
+#include <type_traits> // needed for std::false_type
+#include <memory_resource> // needed for std::pmr::memory_resource
+
+#include "matrixProfile.h" // counts allocations when profiling
+
+// every matrix buffer starts on a cache line boundary (which is also wide enough for any SIMD register)
+inline constexpr size_t MATRIX_ALIGNMENT = 64;
+
+/**
+ * The resource new `Matrix` buffers come from on this thread when none is given; `nullptr` (the default) is the global heap.
+ * Set it for a block of code with `MatrixResourceScope`
+ * @return std::pmr::memory_resource*& the current resource of this thread
+ */
+inline std::pmr::memory_resource*& currentMatrixResource() {
+    static thread_local std::pmr::memory_resource* resource = nullptr;
+    return resource;
+}
+
+/**
+ * Makes every `Matrix` created on this thread without an explicit allocator (including the temporaries of `a + b`, `a * b`
+ * and `MatrixReader::readMatrix`) take its buffer from `resource` until the scope ends, e.g. one `MatrixPool` per request:
+ *
+ *     MatrixPool pool;
+ *     MatrixResourceScope scope(&pool);
+ *     Matrix<int> c = a * b + a; // from the pool
+ *
+ * Matrices made in the scope must not outlive the resource
+ */
+class MatrixResourceScope {
+public:
+    explicit MatrixResourceScope(std::pmr::memory_resource* resource) : previous(currentMatrixResource()) {
+        currentMatrixResource() = resource;
+    }
+    ~MatrixResourceScope() { currentMatrixResource() = previous; }
+
+    MatrixResourceScope(const MatrixResourceScope&) = delete;
+    MatrixResourceScope& operator=(const MatrixResourceScope&) = delete;
+
+private:
+    std::pmr::memory_resource* previous; // put back when the scope ends
+};
+
+/**
+ * Minimal allocator that hands out memory aligned to `Align` bytes.
+ * `std::vector` only promises `alignof(T)` alignment so we plug this in to get cache line aligned buffers.
+ * By default it uses the global heap; given a `std::pmr::memory_resource` (directly or through a `std::pmr::polymorphic_allocator`)
+ * it asks that instead, e.g. a `MatrixPool` (matrixPool.h) or a `std::pmr::monotonic_buffer_resource` as an arena
+ * @tparam T the type being allocated
+ * @tparam Align the alignment in bytes; must be a power of two
+ */
+template<class T, size_t Align = MATRIX_ALIGNMENT>
+struct AlignedAllocator {
+    typedef T value_type;
+
+    // like `std::pmr`, a buffer stays with the resource it was made with; assigning or moving into a container
+    // copies the elements instead of handing over memory from a resource that may not live as long
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::false_type propagate_on_container_move_assignment;
+    typedef std::false_type propagate_on_container_swap;
+
+    // needed since we have the extra non-type template parameter, otherwise `std::vector` cannot rebind us
+    template<class U> struct rebind { typedef AlignedAllocator<U, Align> other; };
+
+    AlignedAllocator() = default;
+    AlignedAllocator(std::pmr::memory_resource* _resource) : resource(_resource) {}
+    template<class U> AlignedAllocator(const std::pmr::polymorphic_allocator<U>& other) : resource(other.resource()) {}
+    template<class U> AlignedAllocator(const AlignedAllocator<U, Align>& other) : resource(other.resource) {}
+
+    T* allocate(size_t n) {
+        MATRIX_PROFILE_ALLOC(n * sizeof(T));
+        if (resource) return static_cast<T*>(resource->allocate(n * sizeof(T), Align));
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Align}));
+    }
+
+    void deallocate(T* p, size_t n) {
+        if (resource) resource->deallocate(p, n * sizeof(T), Align);
+        else ::operator delete(p, std::align_val_t{Align});
+    }
+
+    // `std::vector` value-initializes (zeroes) new elements unless the allocator says otherwise; buffers that are
+    // about to be overwritten anyway (`vector(n)`, `resize(n)`) are only default-initialized so we skip that extra pass
+    template<class U>
+    void construct(U* p) { ::new (static_cast<void*>(p)) U; }
+
+    template<class U, class... Args>
+    void construct(U* p, Args&&... args) { ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...); }
+
+    // two allocators are interchangeable if memory from one can be freed by the other
+    template<class U> bool operator==(const AlignedAllocator<U, Align>& other) const {
+        return resource == other.resource || (resource && other.resource && resource->is_equal(*other.resource));
+    }
+    template<class U> bool operator!=(const AlignedAllocator<U, Align>& other) const { return !(*this == other); }
+
+    std::pmr::memory_resource* resource = nullptr; // where the memory comes from; `nullptr` is the global heap
+};
@@ -0,0 +1,251 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <vector> // needed for the per-matrix results
+#include <algorithm> // needed for std::min, std::max and std::fill
+#include <stdexcept> // needed for throwing errors
+
+#include "matrix.h" // single matrices go in and come out as `Matrix<T>`
+#include "matrixAllocator.h" // aligned storage so every cell's lane array starts on a cache line
+#include "matrixSimd.h" // the vector kernels the batched operations run on
+#include "threadPool.h" // splits a batch over threads
+
+/**
+ * Many matrices of the same shape stored together so one operation runs over all of them at once.
+ * The storage is structure-of-arrays: cell (i, j) of every matrix sits in one contiguous "lane array"
+ * (`cell(i, j)[m]` is cell (i, j) of matrix m), so the vector kernels work across matrices instead of within one.
+ * A 4x4 multiply is then 64 vector multiply-adds over the whole batch instead of a million tiny kernels.
+ *
+ *     BatchedMatrices<int> a(4, 4), b(4, 4);
+ *     stream.readBatch(a); // fill straight from a file (see `MatrixStream::readBatch`)
+ *     BatchedMatrices<int> c = a * b; // pairwise: c[m] = a[m] * b[m]
+ *     std::vector<int> t = c.traces();
+ *
+ * Operations are split over the thread pool by matrix index
+ * @tparam T the element type
+ */
+template<class T>
+class BatchedMatrices {
+    typedef std::vector<T, AlignedAllocator<T>> buffer_t;
+
+public:
+    typedef T value_type; // the element type
+
+    // lane arrays are padded to a whole number of cache lines so each one starts aligned
+    static constexpr size_t LANE_ALIGNMENT = MATRIX_ALIGNMENT / sizeof(T) > 0 ? MATRIX_ALIGNMENT / sizeof(T) : 1;
+
+    /**
+     * @brief Construct a new BatchedMatrices holding `count` `rows` x `cols` matrices, every cell zero
+     * @param _rows the number of rows of every matrix
+     * @param _cols the number of cols of every matrix
+     * @param count how many matrices to start with
+     */
+    BatchedMatrices(size_t _rows = 0, size_t _cols = 0, size_t count = 0) : rows(_rows), cols(_cols) { resize(count); }
+
+    size_t size() const { return count; } // the number of matrices
+    bool empty() const { return count == 0; }
+    size_t numRows() const { return rows; } // the number of rows of every matrix
+    size_t numCols() const { return cols; } // the number of cols of every matrix
+
+    /**
+     * The lane array of one cell: `cell(i, j)[m]` is cell (i, j) of matrix m
+     * @param row the row of the cell
+     * @param col the col of the cell
+     * @return T* pointer to `size()` values, aligned to `MATRIX_ALIGNMENT`
+     */
+    T* cell(size_t row, size_t col) { return data.data() + (row * cols + col) * capacity; }
+    const T* cell(size_t row, size_t col) const { return data.data() + (row * cols + col) * capacity; }
+
+    /**
+     * Unchecked element access
+     * @param m the matrix index
+     * @param row the row of the element
+     * @param col the col of the element
+     * @return T& reference to the element
+     */
+    T& operator()(size_t m, size_t row, size_t col) { return cell(row, col)[m]; }
+    const T& operator()(size_t m, size_t row, size_t col) const { return cell(row, col)[m]; }
+
+    /**
+     * Changes the number of matrices; new ones are all zero
+     * @param n the new number of matrices
+     */
+    void resize(size_t n) {
+        if (n > capacity) reserve(std::max(n, 2 * capacity));
+        for (size_t c = 0; c < rows * cols; c++) { // zero what the new matrices cover, so a shrink then grow does not bring back old values
+            T* lane = data.data() + c * capacity;
+            if (n > count) std::fill(lane + count, lane + n, T{});
+        }
+        count = n;
+    }
+
+    /**
+     * Makes room for `n` matrices so appending up to that many does not move the storage again
+     * @param n the number of matrices to make room for
+     */
+    void reserve(size_t n) {
+        if (n <= capacity) return;
+        const size_t newCapacity = (n + LANE_ALIGNMENT - 1) / LANE_ALIGNMENT * LANE_ALIGNMENT;
+        buffer_t grown(rows * cols * newCapacity);
+        for (size_t c = 0; c < rows * cols; c++) // every lane array moves to its new, longer slot
+            std::copy(data.data() + c * capacity, data.data() + c * capacity + count, grown.data() + c * newCapacity);
+        data.swap(grown);
+        capacity = newCapacity;
+    }
+
+    /**
+     * Appends a matrix to the end of the batch
+     * @param m the matrix to add; must be `numRows()` x `numCols()`
+     */
+    void push(MatrixView<const T> m) {
+        if (m.numRows() != rows || m.numCols() != cols) {
+            throw std::invalid_argument("Matrix dimensions do not match the batch.");
+        }
+        const size_t index = count;
+        resize(count + 1);
+        for (size_t i = 0; i < rows; i++)
+            for (size_t j = 0; j < cols; j++) cell(i, j)[index] = m(i, j);
+    }
+    void push(const Matrix<T>& m) { push(m.view()); }
+
+    /**
+     * Copies one matrix out of the batch
+     * @param m the matrix index
+     * @return Matrix<T> matrix m
+     */
+    Matrix<T> get(size_t m) const {
+        if (m >= count) throw std::out_of_range("Matrix index out of range.");
+        Matrix<T> result(rows, cols);
+        for (size_t i = 0; i < rows; i++)
+            for (size_t j = 0; j < cols; j++) result(i, j) = cell(i, j)[m];
+        return result;
+    }
+
+    /**
+     * The trace (main diagonal sum) of every matrix
+     * @return std::vector<T> one trace per matrix
+     */
+    std::vector<T> traces() const {
+        // same check as for a single matrix
+        if (rows != cols) {
+            throw std::invalid_argument("Trace is only defined for square matrices.");
+        }
+        return diagonalSums([](size_t i) { return i; });
+    }
+
+    /**
+     * The secondary diagonal sum (top right to bottom left) of every matrix
+     * @return std::vector<T> one sum per matrix
+     */
+    std::vector<T> secondaryDiagonalSums() const {
+        // same check as for a single matrix
+        if (rows != cols) {
+            throw std::invalid_argument("Secondary diagonal sum is only defined for square matrices.");
+        }
+        return diagonalSums([this](size_t i) { return cols - 1 - i; });
+    }
+
+    /**
+     * Runs `fn(lo, hi)` over ranges of matrix indices on the thread pool. Ranges start on a lane alignment boundary so
+     * no two threads write to the same cache line
+     * @param cellsPerMatrix about how many values one matrix's share of the work touches
+     * @param fn the work
+     */
+    template<class F>
+    void forEachRange(size_t cellsPerMatrix, F&& fn) const {
+        const size_t perGrain = std::max<size_t>(1, ThreadPool::minParallelElements / std::max<size_t>(cellsPerMatrix, 1));
+        const size_t grain = (perGrain + LANE_ALIGNMENT - 1) / LANE_ALIGNMENT * LANE_ALIGNMENT;
+        parallelFor(0, count, grain, fn);
+    }
+
+private:
+    // adds up one cell per row of every matrix; `colOf(i)` picks the cell of row i
+    template<class F>
+    std::vector<T> diagonalSums(F colOf) const {
+        std::vector<T> sums(count, T{});
+        forEachRange(rows, [&](size_t lo, size_t hi) {
+            for (size_t i = 0; i < rows; i++) simd::add(sums.data() + lo, cell(i, colOf(i)) + lo, sums.data() + lo, hi - lo);
+        });
+        return sums;
+    }
+
+    size_t rows, cols; // the shape of every matrix
+    size_t count = 0; // the number of matrices
+    size_t capacity = 0; // how long every lane array is; a multiple of `LANE_ALIGNMENT`
+    buffer_t data; // `rows * cols` lane arrays of `capacity` values, one after another
+};
+
+/**
+ * Pairwise addition of two batches: result[m] = a[m] + b[m]
+ * @return BatchedMatrices<T> the sums
+ */
+template<class T>
+BatchedMatrices<T> operator+(const BatchedMatrices<T>& a, const BatchedMatrices<T>& b) {
+    // Can only add matrices of the same size so we check that we can
+    if (a.numRows() != b.numRows() || a.numCols() != b.numCols()) {
+        throw std::invalid_argument("Matrix dimensions must match for addition.");
+    }
+    if (a.size() != b.size()) {
+        throw std::invalid_argument("Batches must hold the same number of matrices.");
+    }
+    BatchedMatrices<T> result(a.numRows(), a.numCols(), a.size());
+    a.forEachRange(a.numRows() * a.numCols(), [&](size_t lo, size_t hi) {
+        for (size_t i = 0; i < a.numRows(); i++)
+            for (size_t j = 0; j < a.numCols(); j++)
+                simd::add(a.cell(i, j) + lo, b.cell(i, j) + lo, result.cell(i, j) + lo, hi - lo);
+    });
+    return result;
+}
+
+/**
+ * Pairwise multiplication of two batches into a batch the caller already owns: out[m] = a[m] * b[m].
+ * Matrices are worked on in tiles small enough to stay in the cache; within a tile every (i, j, k) step is one vector
+ * multiply-add across all of the tile's matrices
+ * @param out the destination; reshaped to fit (only allocates if it is not big enough); must not be `a` or `b`
+ * @param a the left matrices
+ * @param b the right matrices
+ */
+template<class T>
+void multiplyInto(BatchedMatrices<T>& out, const BatchedMatrices<T>& a, const BatchedMatrices<T>& b) {
+    // Matrix multiplication needs the left matrix cols to be equal to the right's row number
+    if (a.numCols() != b.numRows()) {
+        throw std::invalid_argument("Matrix dimensions do not allow multiplication.");
+    }
+    if (a.size() != b.size()) {
+        throw std::invalid_argument("Batches must hold the same number of matrices.");
+    }
+    if (&out == &a || &out == &b) { // the cells of the product are written while the operands are still being read
+        throw std::invalid_argument("Output matrix of multiplyInto must not be one of its operands.");
+    }
+    const size_t M = a.numRows(), N = b.numCols(), K = a.numCols();
+    if (out.numRows() != M || out.numCols() != N) out = BatchedMatrices<T>(M, N);
+    out.resize(a.size());
+
+    // a tile's share of a, b and out fits in about 256 KiB (a typical L2)
+    const size_t perMatrix = (M * K + K * N + M * N) * sizeof(T);
+    const size_t tile = std::max<size_t>(BatchedMatrices<T>::LANE_ALIGNMENT, (size_t(256) << 10) / std::max<size_t>(perMatrix, 1));
+
+    a.forEachRange(M * N * K, [&](size_t lo, size_t hi) {
+        for (size_t t = lo; t < hi; t += tile) {
+            const size_t n = std::min(tile, hi - t);
+            for (size_t i = 0; i < M; i++) {
+                for (size_t j = 0; j < N; j++) {
+                    T* c = out.cell(i, j) + t;
+                    std::fill(c, c + n, T{});
+                    for (size_t k = 0; k < K; k++) simd::multiplyAdd(a.cell(i, k) + t, b.cell(k, j) + t, c, c, n);
+                }
+            }
+        }
+    });
+}
+
+/**
+ * Pairwise multiplication of two batches: result[m] = a[m] * b[m]
+ * @return BatchedMatrices<T> the products
+ */
+template<class T>
+BatchedMatrices<T> operator*(const BatchedMatrices<T>& a, const BatchedMatrices<T>& b) {
+    BatchedMatrices<T> result(a.numRows(), b.numCols());
+    multiplyInto(result, a, b);
+    return result;
+}
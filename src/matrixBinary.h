@@ -0,0 +1,363 @@
+#pragma once // header guard
+
+#include "matrix.h" // matrix class definition
+
+#include <cstddef> // needed for `size_t`
+#include <cstdint> // needed for the fixed width header fields
+#include <cstring> // needed for std::memcpy and std::memcmp
+#include <algorithm> // needed for std::min
+#include <fstream> // needed to write the file and to check the magic bytes
+#include <string> // needed for std::string
+#include <stdexcept> // needed for exceptions
+#include <type_traits> // needed to map `T` to a type tag
+#include <utility> // needed for std::exchange
+
+#include <sys/mman.h> // needed for mmap
+#include <sys/stat.h> // needed for fstat
+#include <fcntl.h> // needed for open
+#include <unistd.h> // needed for close
+
+/**
+ * A binary container for many matrices of the same size and type, so they can be loaded without parsing any text.
+ *
+ * Layout (all numbers in the byte order of the machine that wrote it; the header records which one):
+ *   - a 64 byte `binfmt::Header` (magic, version, element type, rows, cols, alignment, count, ...)
+ *   - padding up to `dataOffset`
+ *   - `count` matrices back to back, each stored row-major and padded to a multiple of `alignment` bytes
+ *
+ * Since `mmap` hands out page aligned memory, every matrix in a mapped file starts on an `alignment` boundary,
+ * just like the buffer of a `Matrix`, so the SIMD kernels see the same alignment either way
+ */
+namespace binfmt {
+
+    inline constexpr char MAGIC[8] = {'M', 'A', 'T', 'R', 'I', 'X', 'B', '\0'}; // first 8 bytes of every file
+    inline constexpr uint32_t VERSION = 1; // bumped whenever the layout changes
+    inline constexpr uint32_t BYTE_ORDER_MARK = 0x01020304; // reads back differently on a machine of the other byte order
+
+    // the element types the format knows about
+    enum class ElementType : uint32_t {
+        Int32 = 1,
+        Int64 = 2,
+        UInt32 = 3,
+        UInt64 = 4,
+        Float32 = 5,
+        Float64 = 6,
+    };
+
+    /**
+     * The type tag for `T`; fails to compile for types the format cannot store
+     * @return ElementType the tag written into the header
+     */
+    template<class T>
+    constexpr ElementType elementTypeOf() {
+        if constexpr (std::is_same_v<T, float>) return ElementType::Float32;
+        else if constexpr (std::is_same_v<T, double>) return ElementType::Float64;
+        else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) == 4)
+            return std::is_signed_v<T> ? ElementType::Int32 : ElementType::UInt32;
+        else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) == 8)
+            return std::is_signed_v<T> ? ElementType::Int64 : ElementType::UInt64;
+        else static_assert(sizeof(T) == 0, "matrix binary format only stores 32/64 bit integers, float and double");
+    }
+
+    // a readable name for a type tag (for error messages and the converter)
+    inline const char* elementTypeName(uint32_t type) {
+        switch (static_cast<ElementType>(type)) {
+            case ElementType::Int32: return "int32";
+            case ElementType::Int64: return "int64";
+            case ElementType::UInt32: return "uint32";
+            case ElementType::UInt64: return "uint64";
+            case ElementType::Float32: return "float32";
+            case ElementType::Float64: return "float64";
+        }
+        return "unknown";
+    }
+
+    // the start of every file; exactly 64 bytes
+    struct Header {
+        char magic[8]; // `MAGIC`
+        uint32_t version; // `VERSION`
+        uint32_t byteOrder; // `BYTE_ORDER_MARK` as the writer saw it
+        uint32_t elementType; // an `ElementType`
+        uint32_t elementSize; // `sizeof` one element
+        uint64_t alignment; // every matrix starts on a multiple of this many bytes
+        uint64_t rows; // rows of every matrix
+        uint64_t cols; // cols of every matrix
+        uint64_t count; // how many matrices follow
+        uint64_t dataOffset; // where the first matrix starts
+    };
+    static_assert(sizeof(Header) == 64, "binfmt::Header must stay 64 bytes");
+
+    /**
+     * a * b, unless that does not fit in 64 bits; the sizes in a header come from the file, so they are never multiplied unchecked
+     * @param product set to a * b if it fits
+     * @return bool false if the product would wrap around
+     */
+    inline bool checkedMultiply(uint64_t a, uint64_t b, uint64_t& product) {
+        if (a != 0 && b > UINT64_MAX / a) return false;
+        product = a * b;
+        return true;
+    }
+
+    /**
+     * Checks if a file is in this format by its first bytes, without mapping it
+     * @param filename the file to look at
+     * @return bool true if it starts with `MAGIC`
+     */
+    inline bool isBinaryFile(const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary);
+        char magic[sizeof(MAGIC)] = {};
+        file.read(magic, sizeof(magic));
+        return file && std::memcmp(magic, MAGIC, sizeof(magic)) == 0;
+    }
+
+    /**
+     * Throws unless `header` is one this code can read: the magic bytes, the version and the byte order.
+     * The element type and the sizes are left to `MappedMatrixFile`, which knows the type it wants
+     * @param header the first 64 bytes of the file
+     * @param filename the file, for the error message
+     */
+    inline void checkHeader(const Header& header, const std::string& filename) {
+        if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0)
+            throw std::runtime_error("Not a binary matrix file: " + filename);
+        if (header.version != VERSION)
+            throw std::runtime_error("Unsupported binary matrix file version " + std::to_string(header.version) + ": " + filename);
+        if (header.byteOrder != BYTE_ORDER_MARK)
+            throw std::runtime_error("Binary matrix file was written with a different byte order: " + filename);
+    }
+
+    /**
+     * Reads and checks (`checkHeader`) the header of a binary file, e.g. to find out which element type to open it as
+     * @param filename the file to read
+     * @return Header the header
+     */
+    inline Header readHeader(const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) throw std::runtime_error("Could not open file: " + filename);
+        Header header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (file.gcount() != static_cast<std::streamsize>(sizeof(header)))
+            throw std::runtime_error("File is too small to be a binary matrix file: " + filename);
+        checkHeader(header, filename);
+        return header;
+    }
+
+    // bytes one matrix takes up in the file, padding included; only for headers that passed `MappedMatrixFile`'s checks
+    inline uint64_t matrixStride(const Header& h) {
+        const uint64_t bytes = h.rows * h.cols * h.elementSize;
+        return (bytes + h.alignment - 1) / h.alignment * h.alignment;
+    }
+}
+
+/**
+ * Writes matrices into the binary format one at a time. The matrix count in the header is filled in by `close()`
+ * (or the destructor), so the number of matrices does not need to be known up front
+ * @tparam T the element type
+ */
+template<class T>
+class BinaryMatrixWriter {
+public:
+    /**
+     * @brief Opens `filename` for writing (replacing it) and writes the header
+     * @param filename path of the file to create
+     * @param rows the rows of every matrix that will be written
+     * @param cols the cols of every matrix that will be written
+     * @param alignment every matrix starts on a multiple of this many bytes (a power of two, at least `alignof(T)`)
+     */
+    BinaryMatrixWriter(const std::string& filename, size_t rows, size_t cols, size_t alignment = MATRIX_ALIGNMENT)
+      : file(filename, std::ios::binary | std::ios::trunc) {
+        if (!file.is_open()) throw std::runtime_error("Could not open file: " + filename);
+        if (alignment < alignof(T) || (alignment & (alignment - 1)) != 0)
+            throw std::invalid_argument("Alignment must be a power of two of at least the element alignment.");
+
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, binfmt::MAGIC, sizeof(header.magic));
+        header.version = binfmt::VERSION;
+        header.byteOrder = binfmt::BYTE_ORDER_MARK;
+        header.elementType = static_cast<uint32_t>(binfmt::elementTypeOf<T>());
+        header.elementSize = sizeof(T);
+        header.alignment = alignment;
+        header.rows = rows;
+        header.cols = cols;
+        header.dataOffset = (sizeof(header) + alignment - 1) / alignment * alignment;
+
+        writeHeader();
+        pad(header.dataOffset - sizeof(header));
+    }
+
+    BinaryMatrixWriter(const BinaryMatrixWriter&) = delete;
+    BinaryMatrixWriter& operator=(const BinaryMatrixWriter&) = delete;
+
+    ~BinaryMatrixWriter() {
+        try { close(); } catch (...) {} // a destructor must not throw; call `close()` yourself to see errors
+    }
+
+    /**
+     * Appends one matrix
+     * @param m the matrix (or any view of one); must be `rows x cols`
+     */
+    void write(MatrixView<const T> m) {
+        if (!file.is_open()) throw std::runtime_error("Binary matrix file is already closed.");
+        if (m.numRows() != header.rows || m.numCols() != header.cols)
+            throw std::invalid_argument("Matrix dimensions do not match the binary file.");
+
+        if (m.stride() == m.numCols()) { // contiguous; one write for the whole matrix
+            file.write(reinterpret_cast<const char*>(m.data()), static_cast<std::streamsize>(m.numRows() * m.numCols() * sizeof(T)));
+        } else { // a block of a bigger matrix; one write per row
+            for (size_t i = 0; i < m.numRows(); i++)
+                file.write(reinterpret_cast<const char*>(&m(i, 0)), static_cast<std::streamsize>(m.numCols() * sizeof(T)));
+        }
+        pad(binfmt::matrixStride(header) - header.rows * header.cols * sizeof(T));
+        if (!file) throw std::runtime_error("Could not write matrix data.");
+        header.count++;
+    }
+
+    void write(const Matrix<T>& m) { write(m.view()); }
+
+    // how many matrices have been written so far
+    size_t count() const { return header.count; }
+
+    /**
+     * Fills in the final matrix count and closes the file; does nothing if it is already closed
+     */
+    void close() {
+        if (!file.is_open()) return;
+        file.seekp(0);
+        writeHeader();
+        file.close();
+        if (!file) throw std::runtime_error("Could not finish writing the binary matrix file.");
+    }
+
+private:
+    void writeHeader() { file.write(reinterpret_cast<const char*>(&header), sizeof(header)); }
+
+    void pad(size_t bytes) {
+        static constexpr char zeros[64] = {};
+        while (bytes > 0) {
+            const size_t n = std::min(bytes, sizeof(zeros));
+            file.write(zeros, static_cast<std::streamsize>(n));
+            bytes -= n;
+        }
+    }
+
+    std::ofstream file; // the file being written
+    binfmt::Header header; // kept up to date with the count and written again on `close()`
+};
+
+/**
+ * Maps a binary matrix file into memory (read-only) and hands out each matrix as a `MatrixView<const T>`.
+ * Nothing is copied or parsed: the views point straight into the mapping and the OS pages data in as it is touched.
+ * A view works wherever a read-only `Matrix<T>` does: `file[0] + file[1]`, `file[0] * m`, `multiplyInto(out, file[0], file[1])`,
+ * `trace()` and printing all read the mapping in place.
+ * The views are only valid while the `MappedMatrixFile` is alive
+ * @tparam T the element type; must match the type stored in the file
+ */
+template<class T>
+class MappedMatrixFile {
+public:
+    typedef MatrixView<const T> view_t;
+
+    /**
+     * @brief Maps `filename` and checks its header
+     * @param filename path of a file written by `BinaryMatrixWriter`
+     */
+    explicit MappedMatrixFile(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Could not open file: " + filename);
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not read the size of file: " + filename);
+        }
+        length = static_cast<size_t>(st.st_size);
+        if (length < sizeof(binfmt::Header)) {
+            ::close(fd);
+            throw std::runtime_error("File is too small to be a binary matrix file: " + filename);
+        }
+
+        void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // the mapping keeps the file alive on its own
+        if (p == MAP_FAILED) throw std::runtime_error("Could not map file: " + filename);
+        base = static_cast<const char*>(p);
+
+        try {
+            validate(filename);
+        } catch (...) {
+            ::munmap(const_cast<char*>(base), length);
+            throw;
+        }
+        ::madvise(const_cast<char*>(base), length, MADV_SEQUENTIAL); // matrices are usually read front to back
+    }
+
+    MappedMatrixFile(const MappedMatrixFile&) = delete;
+    MappedMatrixFile& operator=(const MappedMatrixFile&) = delete;
+
+    MappedMatrixFile(MappedMatrixFile&& other) noexcept
+      : base(std::exchange(other.base, nullptr)), length(std::exchange(other.length, 0)), header(other.header) {}
+
+    MappedMatrixFile& operator=(MappedMatrixFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            base = std::exchange(other.base, nullptr);
+            length = std::exchange(other.length, 0);
+            header = other.header;
+        }
+        return *this;
+    }
+
+    ~MappedMatrixFile() { unmap(); }
+
+    size_t size() const { return header.count; } // number of matrices in the file
+    size_t numRows() const { return header.rows; } // rows of every matrix
+    size_t numCols() const { return header.cols; } // cols of every matrix
+
+    /**
+     * The `k`th matrix; unchecked
+     * @param k which matrix (0 based)
+     * @return view_t a read-only view into the mapping
+     */
+    view_t operator[](size_t k) const {
+        const T* p = reinterpret_cast<const T*>(base + header.dataOffset + k * binfmt::matrixStride(header));
+        return view_t(p, header.rows, header.cols);
+    }
+
+    /**
+     * The `k`th matrix; checked
+     * @param k which matrix (0 based)
+     * @return view_t a read-only view into the mapping
+     */
+    view_t at(size_t k) const {
+        if (k >= header.count) throw std::out_of_range("Matrix index out of range.");
+        return (*this)[k];
+    }
+
+private:
+    // throws if the file is not a binary matrix file holding `T`, or if it is cut short
+    void validate(const std::string& filename) {
+        std::memcpy(&header, base, sizeof(header));
+        binfmt::checkHeader(header, filename);
+        if (header.elementType != static_cast<uint32_t>(binfmt::elementTypeOf<T>()) || header.elementSize != sizeof(T))
+            throw std::runtime_error(std::string("Binary matrix file holds ") + binfmt::elementTypeName(header.elementType) +
+                                     " but " + binfmt::elementTypeName(static_cast<uint32_t>(binfmt::elementTypeOf<T>())) +
+                                     " was requested: " + filename);
+        if (header.alignment < alignof(T) || (header.alignment & (header.alignment - 1)) != 0 ||
+            header.dataOffset < sizeof(header) || header.dataOffset % header.alignment != 0)
+            throw std::runtime_error("Corrupt binary matrix file header: " + filename);
+        // every size is checked before it is used, so a crafted header cannot wrap around and pass the length check
+        uint64_t cells = 0, bytes = 0, total = 0;
+        if (!binfmt::checkedMultiply(header.rows, header.cols, cells) || !binfmt::checkedMultiply(cells, header.elementSize, bytes) ||
+            bytes > UINT64_MAX - (header.alignment - 1) || header.dataOffset > length)
+            throw std::runtime_error("Corrupt binary matrix file header: " + filename);
+        if (!binfmt::checkedMultiply(header.count, binfmt::matrixStride(header), total) || total > length - header.dataOffset)
+            throw std::runtime_error("Unexpected end of file while reading matrix data.");
+    }
+
+    void unmap() {
+        if (base) ::munmap(const_cast<char*>(base), length);
+        base = nullptr;
+    }
+
+    const char* base = nullptr; // start of the mapping
+    size_t length = 0; // bytes mapped
+    binfmt::Header header{}; // copy of the file's header
+};
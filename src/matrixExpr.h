@@ -0,0 +1,452 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <optional> // needed to cache a product that is used inside an elementwise expression
+#include <type_traits> // needed for the operand traits
+#include <utility> // needed for std::forward
+#include <algorithm> // needed for std::copy and std::min
+#include <stdexcept> // needed for throwing errors
+#include <iostream> // needed to print expressions
+
+#include "matrix.h" // the Matrix class the expressions are built from
+
+/**
+ * Expression templates for `Matrix<T>` arithmetic.
+ * `a + b`, `a - b`, `a * s` and `a * b` do not compute anything, they return a small object that remembers the
+ * operation and its operands. The work happens once the expression is assigned to (or used to build) a `Matrix`:
+ *  - a chain of elementwise operations like `a + b - 2 * c` runs as ONE pass over memory, a cache sized block at a time,
+ *    with no intermediate matrices
+ *  - `s * x + y` becomes a single fused multiply-add (`simd::axpy`)
+ *  - `A * B + C` copies C into the destination and lets the multiply kernel accumulate straight on top of it
+ *  - `trace()` / `secondaryDiagonalSum()` of an expression only compute the diagonal cells
+ *
+ * Plain matrices passed as lvalues are held by reference (so an expression must not outlive them, just like
+ * with any other reference; prefer `Matrix<T> m = a + b;` over `auto m = a + b;`), temporaries are moved into the expression.
+ * Views (`MatrixView<T>`, e.g. a submatrix or a matrix in a `MappedMatrixFile`) are operands too and are read in place
+ */
+
+// how many cells of an elementwise expression are computed at a time; small enough for the scratch buffers to stay in L1
+inline constexpr size_t MATRIX_EXPR_BLOCK = 256;
+
+/**
+ * Base of every expression node (CRTP). Each node provides:
+ *  - `numRows()` / `numCols()`
+ *  - `at(i, j)` computes a single cell
+ *  - `block(lo, n, scratch)` computes the `n` cells starting at flat index `lo`; it may write them into `scratch`
+ *    (which has room for `n` cells) or return a pointer to where they already are
+ *  - `prepare()` is called once before `block` is used (products compute themselves there)
+ *  - `reads(begin, end)` is true if an operand somewhere in the expression has cells in the memory range [begin, end)
+ *  - `unsafeAlias(begin, end)` is true if writing the result into the buffer [begin, end) would overwrite an operand before it is read
+ * @tparam Derived the node type
+ */
+template<class Derived>
+class MatrixExpr {
+public:
+    const Derived& derived() const { return static_cast<const Derived&>(*this); }
+
+    /**
+     * Writes the whole result into `out`, which holds `numRows() * numCols()` cells in row-major order.
+     * The default is the fused elementwise pass; products override it
+     */
+    template<class T>
+    void evaluateInto(T* out) const {
+        const Derived& e = derived();
+        MATRIX_PROFILE_SCOPE(Elementwise, e.numRows() * e.numCols() * sizeof(T));
+        e.prepare();
+        parallelFor(0, e.numRows() * e.numCols(), ThreadPool::minParallelElements, [&](size_t lo, size_t hi) {
+            for (size_t b = lo; b < hi; b += MATRIX_EXPR_BLOCK) {
+                const size_t n = std::min(MATRIX_EXPR_BLOCK, hi - b);
+                const T* p = e.block(b, n, out + b); // the top node writes straight into the destination
+                if (p != out + b) std::copy(p, p + n, out + b); // a bare matrix hands back its own cells
+            }
+        });
+    }
+
+    size_t numRows() const { return derived().numRows(); }
+    size_t numCols() const { return derived().numCols(); }
+
+    /**
+     * Computes a single cell of the result without evaluating the rest (handy when an expression was kept in an `auto`)
+     * @param row the row of the cell
+     * @param col the col of the cell
+     */
+    auto operator()(size_t row, size_t col) const { return derived().at(row, col); }
+
+    /**
+     * Evaluates the expression into a new matrix
+     */
+    auto eval() const { return Matrix<typename Derived::value_type>(derived()); }
+
+    /**
+     * Trace of the result; only the diagonal cells are computed
+     */
+    auto trace() const {
+        const Derived& e = derived();
+        if (e.numRows() != e.numCols()) {
+            throw std::invalid_argument("Trace is only defined for square matrices.");
+        }
+        typename Derived::value_type sum{};
+        for (size_t i = 0; i < e.numRows(); i++) sum += e.at(i, i);
+        return sum;
+    }
+
+    /**
+     * Secondary diagonal sum of the result; only the secondary diagonal cells are computed
+     */
+    auto secondaryDiagonalSum() const {
+        const Derived& e = derived();
+        if (e.numRows() != e.numCols()) {
+            throw std::invalid_argument("Secondary diagonal sum is only defined for square matrices.");
+        }
+        typename Derived::value_type sum{};
+        const size_t n = e.numCols();
+        for (size_t i = 0; i < n; i++) sum += e.at(i, (n - 1) - i);
+        return sum;
+    }
+
+    // prints the evaluated result with the same layout as a `Matrix`
+    friend std::ostream& operator<<(std::ostream& os, const MatrixExpr& e) { return os << e.eval(); }
+};
+
+/**
+ * Wraps a plain matrix so it can sit in an expression tree.
+ * @tparam M either `const Matrix<T>&` (an lvalue the expression only points at) or `Matrix<T>` (a temporary it owns)
+ */
+template<class M>
+class MatrixLeaf : public MatrixExpr<MatrixLeaf<M>> {
+public:
+    typedef typename std::decay_t<M>::value_type value_type;
+
+    template<class X, std::enable_if_t<std::is_same_v<std::decay_t<X>, Matrix<value_type>>, int> = 0>
+    explicit MatrixLeaf(X&& m) : matrix(std::forward<X>(m)) {}
+
+    size_t numRows() const { return matrix.numRows(); }
+    size_t numCols() const { return matrix.numCols(); }
+    value_type at(size_t i, size_t j) const { return matrix(i, j); }
+    const value_type* block(size_t lo, size_t, value_type*) const { return matrix.ptr() + lo; } // no copy needed
+    void prepare() const {}
+    bool reads(const void* begin, const void* end) const { return matrix.view().overlaps(begin, end); }
+    // cell `k` is always read before cell `k` is written, and no other matrix shares the buffer
+    bool unsafeAlias(const void*, const void*) const { return false; }
+    const Matrix<value_type>& get() const { return matrix; }
+
+private:
+    M matrix;
+};
+
+/**
+ * Wraps a read-only view (a submatrix, a matrix in a `MappedMatrixFile`, ...) so it can sit in an expression tree
+ * without being copied into a `Matrix` first. The view is held by value; the cells it points at must outlive the expression
+ * @tparam T the element type
+ */
+template<class T>
+class ViewLeaf : public MatrixExpr<ViewLeaf<T>> {
+public:
+    typedef T value_type;
+
+    explicit ViewLeaf(MatrixView<const T> _view) : view(_view) {}
+
+    size_t numRows() const { return view.numRows(); }
+    size_t numCols() const { return view.numCols(); }
+    value_type at(size_t i, size_t j) const { return view(i, j); }
+    void prepare() const {}
+    bool reads(const void* begin, const void* end) const { return view.overlaps(begin, end); }
+
+    // safe only when the view is the whole destination (cell `k` is then read before it is written) or lies outside it
+    bool unsafeAlias(const void* begin, const void* end) const {
+        return !(contiguous() && view.data() == begin) && view.overlaps(begin, end);
+    }
+
+    const value_type* block(size_t lo, size_t n, value_type* scratch) const {
+        if (contiguous()) return view.data() + lo; // no copy needed
+        // the rows have gaps between them, so the `n` cells are gathered a row piece at a time
+        const size_t cols = view.numCols();
+        size_t i = lo / cols, j = lo % cols;
+        for (value_type* out = scratch; n > 0; i++, j = 0) {
+            const size_t take = std::min(n, cols - j);
+            out = std::copy(&view(i, j), &view(i, j) + take, out);
+            n -= take;
+        }
+        return scratch;
+    }
+
+    const MatrixView<const T>& get() const { return view; }
+
+private:
+    bool contiguous() const { return view.stride() == view.numCols(); }
+
+    MatrixView<const T> view;
+};
+
+// traits to tell the different operands apart
+template<class X> struct isMatrix : std::false_type {};
+template<class T> struct isMatrix<Matrix<T>> : std::true_type {};
+template<class X> inline constexpr bool isMatrixV = isMatrix<std::decay_t<X>>::value;
+template<class X> struct isView : std::false_type {};
+template<class T> struct isView<MatrixView<T>> : std::true_type {};
+template<class X> inline constexpr bool isViewV = isView<std::decay_t<X>>::value;
+template<class X> inline constexpr bool isExprV = std::is_base_of_v<MatrixExpr<std::decay_t<X>>, std::decay_t<X>>;
+template<class X> inline constexpr bool isOperandV = isMatrixV<X> || isViewV<X> || isExprV<X>;
+
+// a scalar `S` can scale a matrix of `T` if it converts without narrowing (so `Matrix<int> * 2.5` does not compile instead of
+// quietly scaling by 2); whole numbers scaling a floating point matrix (`Matrix<double> * 2`) are allowed too
+template<class S, class T, class = void> struct isScalarFor : std::bool_constant<std::is_integral_v<S> && std::is_floating_point_v<T>> {};
+template<class S, class T> struct isScalarFor<S, T, std::void_t<decltype(T{std::declval<const S&>()})>> : std::true_type {};
+template<class S, class T> inline constexpr bool isScalarForV = !isOperandV<S> && isScalarFor<S, T>::value;
+
+template<class X> struct isLeaf : std::false_type {};
+template<class M> struct isLeaf<MatrixLeaf<M>> : std::true_type {};
+template<class T> struct isLeaf<ViewLeaf<T>> : std::true_type {};
+
+/**
+ * How an operand is stored inside a node: lvalue matrices by reference, temporary matrices by value, views by value
+ * (as read-only views) and sub-expressions by value (they are only a few pointers big)
+ */
+template<class X, class D = std::decay_t<X>>
+struct operandOf { typedef D type; };
+template<class X, class T>
+struct operandOf<X, Matrix<T>> {
+    typedef MatrixLeaf<std::conditional_t<std::is_lvalue_reference_v<X>, const Matrix<T>&, Matrix<T>>> type;
+};
+template<class X, class T>
+struct operandOf<X, MatrixView<T>> { typedef ViewLeaf<std::remove_const_t<T>> type; };
+
+template<class X>
+using operand_t = typename operandOf<X>::type;
+
+template<class X>
+operand_t<X> makeOperand(X&& x) { return operand_t<X>(std::forward<X>(x)); }
+
+/**
+ * Gives back the matrix behind an operand; a plain matrix or view is passed through, anything else is evaluated into a temporary
+ */
+template<class E>
+decltype(auto) materialize(const E& e) {
+    if constexpr (isLeaf<E>::value) return (e.get());
+    else return Matrix<typename E::value_type>(e);
+}
+
+// the elementwise operations; each one names its vector kernel and its single cell version
+struct AddOp {
+    template<class T> static void apply(const T* a, const T* b, T* out, size_t n) { simd::add(a, b, out, n); }
+    template<class T> static T apply(const T& a, const T& b) { return a + b; }
+};
+
+struct SubOp {
+    template<class T> static void apply(const T* a, const T* b, T* out, size_t n) { simd::sub(a, b, out, n); }
+    template<class T> static T apply(const T& a, const T& b) { return a - b; }
+};
+
+template<class E> class ScaleExpr;
+template<class X> struct isScale : std::false_type {};
+template<class E> struct isScale<ScaleExpr<E>> : std::true_type {};
+
+template<class L, class R> class ProductExpr;
+template<class X> struct isProduct : std::false_type {};
+template<class L, class R> struct isProduct<ProductExpr<L, R>> : std::true_type {};
+
+/**
+ * Elementwise binary node: `lhs Op rhs`
+ */
+template<class Op, class L, class R>
+class ElementwiseExpr : public MatrixExpr<ElementwiseExpr<Op, L, R>> {
+public:
+    typedef typename L::value_type value_type;
+    static_assert(std::is_same_v<value_type, typename R::value_type>, "Both matrices must have the same element type.");
+
+    ElementwiseExpr(L _lhs, R _rhs) : lhs(std::move(_lhs)), rhs(std::move(_rhs)) {}
+
+    size_t numRows() const { return lhs.numRows(); }
+    size_t numCols() const { return lhs.numCols(); }
+    value_type at(size_t i, size_t j) const { return Op::apply(lhs.at(i, j), rhs.at(i, j)); }
+    void prepare() const { lhs.prepare(); rhs.prepare(); }
+    bool reads(const void* begin, const void* end) const { return lhs.reads(begin, end) || rhs.reads(begin, end); }
+    bool unsafeAlias(const void* begin, const void* end) const {
+        return lhs.unsafeAlias(begin, end) || rhs.unsafeAlias(begin, end);
+    }
+
+    const value_type* block(size_t lo, size_t n, value_type* out) const {
+        // The side that goes second is allowed to use `out` as its scratch, so the first side is computed into `tmp`.
+        // If it hands back `out` itself (the destination is one of the operands) its cells are saved into `tmp`
+        // before the second side writes over them
+        alignas(MATRIX_ALIGNMENT) value_type tmp[MATRIX_EXPR_BLOCK];
+        auto first = [&](const auto& side) {
+            const value_type* p = side.block(lo, n, tmp);
+            if (p == out) p = std::copy(p, p + n, tmp) - n;
+            return p;
+        };
+
+        if constexpr (std::is_same_v<Op, AddOp> && isScale<L>::value) {
+            // `s * x + y`: one fused multiply-add instead of a scale and then an add
+            const value_type* y = first(rhs);
+            simd::axpy(lhs.factor(), lhs.inner().block(lo, n, out), y, out, n);
+        } else if constexpr (std::is_same_v<Op, AddOp> && isScale<R>::value) {
+            // `y + s * x`: same thing the other way round
+            const value_type* y = first(lhs);
+            simd::axpy(rhs.factor(), rhs.inner().block(lo, n, out), y, out, n);
+        } else {
+            const value_type* b = first(rhs);
+            const value_type* a = lhs.block(lo, n, out);
+            Op::apply(a, b, out, n);
+        }
+        return out;
+    }
+
+    /**
+     * A product added to something (`A * B + C`) is done by the multiply kernel in one go: C is written into `out`
+     * and the product is accumulated on top of it. Everything else is the fused elementwise pass
+     */
+    template<class T>
+    void evaluateInto(T* out) const {
+        if constexpr (std::is_same_v<Op, AddOp> && isProduct<L>::value) {
+            rhs.evaluateInto(out);
+            lhs.accumulateInto(out);
+        } else if constexpr (std::is_same_v<Op, AddOp> && isProduct<R>::value) {
+            lhs.evaluateInto(out);
+            rhs.accumulateInto(out);
+        } else {
+            MatrixExpr<ElementwiseExpr>::evaluateInto(out);
+        }
+    }
+
+private:
+    L lhs;
+    R rhs;
+};
+
+/**
+ * Scalar multiple node: `inner * factor`
+ */
+template<class E>
+class ScaleExpr : public MatrixExpr<ScaleExpr<E>> {
+public:
+    typedef typename E::value_type value_type;
+
+    ScaleExpr(E _inner, value_type _factor) : in(std::move(_inner)), s(_factor) {}
+
+    size_t numRows() const { return in.numRows(); }
+    size_t numCols() const { return in.numCols(); }
+    value_type at(size_t i, size_t j) const { return in.at(i, j) * s; }
+    void prepare() const { in.prepare(); }
+    bool reads(const void* begin, const void* end) const { return in.reads(begin, end); }
+    bool unsafeAlias(const void* begin, const void* end) const { return in.unsafeAlias(begin, end); }
+
+    const value_type* block(size_t lo, size_t n, value_type* out) const {
+        simd::scale(in.block(lo, n, out), s, out, n);
+        return out;
+    }
+
+    const E& inner() const { return in; }
+    const value_type& factor() const { return s; }
+
+private:
+    E in;
+    value_type s;
+};
+
+/**
+ * Matrix product node: `lhs * rhs`. Evaluated by the blocked multiply kernel; when it is part of a bigger
+ * elementwise expression it is computed once up front (in `prepare`) and then read like a plain matrix
+ */
+template<class L, class R>
+class ProductExpr : public MatrixExpr<ProductExpr<L, R>> {
+public:
+    typedef typename L::value_type value_type;
+    static_assert(std::is_same_v<value_type, typename R::value_type>, "Both matrices must have the same element type.");
+
+    ProductExpr(L _lhs, R _rhs) : lhs(std::move(_lhs)), rhs(std::move(_rhs)) {}
+
+    size_t numRows() const { return lhs.numRows(); }
+    size_t numCols() const { return rhs.numCols(); }
+
+    // a single cell is the dot product of a row of the left and a col of the right
+    value_type at(size_t i, size_t j) const {
+        value_type sum{};
+        for (size_t k = 0; k < lhs.numCols(); k++) sum += lhs.at(i, k) * rhs.at(k, j);
+        return sum;
+    }
+
+    void prepare() const {
+        if (!cache) cache.emplace(*this); // runs `evaluateInto` below
+    }
+
+    const value_type* block(size_t lo, size_t, value_type*) const { return cache->ptr() + lo; }
+    bool reads(const void* begin, const void* end) const { return lhs.reads(begin, end) || rhs.reads(begin, end); }
+    // the multiply reads whole rows and cols of its operands while writing, so it can never write over one of them
+    bool unsafeAlias(const void* begin, const void* end) const { return reads(begin, end); }
+
+    template<class T>
+    void evaluateInto(T* out) const { multiplyInto(out, false); }
+
+    template<class T>
+    void accumulateInto(T* out) const { multiplyInto(out, true); }
+
+private:
+    void multiplyInto(value_type* out, bool accumulate) const {
+        // the kernel needs real cells; plain matrices and views are used as they are, sub-expressions are evaluated first
+        const auto& a = materialize(lhs);
+        const auto& b = materialize(rhs);
+        auto asView = [](const auto& m) -> MatrixView<const value_type> {
+            if constexpr (isMatrixV<decltype(m)>) return m.view();
+            else return m;
+        };
+        multiplyKernel(asView(a), asView(b), out, accumulate); // the blocked kernel, or Strassen if `multiplyPolicy` asks for it
+    }
+
+    L lhs;
+    R rhs;
+    mutable std::optional<Matrix<value_type>> cache; // the evaluated product; only used inside elementwise expressions
+};
+
+/**
+ * Addition operator (+) => (Matrix<T> + Matrix<T>), also works on any mix of matrices and expressions
+ * @return an expression for the sum; computed when it is assigned to a Matrix
+ */
+template<class L, class R, std::enable_if_t<isOperandV<L> && isOperandV<R>, int> = 0>
+auto operator+(L&& l, R&& r) {
+    // Can only add matrices of the same size so we check that we can (straight away, not when it is evaluated)
+    if (l.numRows() != r.numRows() || l.numCols() != r.numCols()) {
+        throw std::invalid_argument("Matrix dimensions must match for addition.");
+    }
+    return ElementwiseExpr<AddOp, operand_t<L>, operand_t<R>>(makeOperand(std::forward<L>(l)), makeOperand(std::forward<R>(r)));
+}
+
+/**
+ * Subtraction operator (-) => (Matrix<T> - Matrix<T>), also works on any mix of matrices and expressions
+ * @return an expression for the difference
+ */
+template<class L, class R, std::enable_if_t<isOperandV<L> && isOperandV<R>, int> = 0>
+auto operator-(L&& l, R&& r) {
+    // same rules as addition
+    if (l.numRows() != r.numRows() || l.numCols() != r.numCols()) {
+        throw std::invalid_argument("Matrix dimensions must match for subtraction.");
+    }
+    return ElementwiseExpr<SubOp, operand_t<L>, operand_t<R>>(makeOperand(std::forward<L>(l)), makeOperand(std::forward<R>(r)));
+}
+
+/**
+ * Multiplies two matrices (or expressions) together
+ * @return an expression for the product
+ */
+template<class L, class R, std::enable_if_t<isOperandV<L> && isOperandV<R>, int> = 0>
+auto operator*(L&& l, R&& r) {
+    // Matrix multiplication needs the left matrix cols to be equal to the right's row number
+    if (l.numCols() != r.numRows()) {
+        throw std::invalid_argument("Matrix dimensions do not allow multiplication.");
+    }
+    return ProductExpr<operand_t<L>, operand_t<R>>(makeOperand(std::forward<L>(l)), makeOperand(std::forward<R>(r)));
+}
+
+/**
+ * Scalar multiplication (Matrix<T> * T); every cell is multiplied by `scalar`
+ * @return an expression for the scaled matrix
+ */
+template<class E, class S, std::enable_if_t<isOperandV<E> && isScalarForV<S, typename operand_t<E>::value_type>, int> = 0>
+auto operator*(E&& e, const S& scalar) {
+    typedef operand_t<E> inner_t;
+    return ScaleExpr<inner_t>(makeOperand(std::forward<E>(e)), static_cast<typename inner_t::value_type>(scalar));
+}
+
+// scalar multiplication the other way round (T * Matrix<T>)
+template<class S, class E, std::enable_if_t<isOperandV<E> && isScalarForV<S, typename operand_t<E>::value_type>, int> = 0>
+auto operator*(const S& scalar, E&& e) { return std::forward<E>(e) * scalar; }
@@ -0,0 +1,258 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <utility> // needed for std::index_sequence and std::swap
+#include <stdexcept> // needed for throwing errors
+#include <iostream> // needed for printing
+
+#include "matrix.h" // the dynamic Matrix<T> this mirrors and converts to and from
+
+/**
+ * Helpers for the fixed size matrix
+ */
+namespace fixed {
+
+    // loops over this many cells or fewer are written out in full; bigger ones are left as loops so the compile time stays sane
+    inline constexpr size_t maxUnroll = 256;
+
+    /**
+     * Calls `fn(i)` for every i in [0, N); fully unrolled when N is at most `maxUnroll`
+     * @tparam N the trip count
+     * @param fn the loop body
+     */
+    template<size_t N, class F>
+    constexpr void forEach(F&& fn) {
+        if constexpr (N <= maxUnroll) {
+            [&]<size_t... I>(std::index_sequence<I...>) { (fn(I), ...); }(std::make_index_sequence<N>{});
+        } else {
+            for (size_t i = 0; i < N; i++) fn(i);
+        }
+    }
+}
+
+/**
+ * A matrix whose dimensions are part of its type, e.g. `Matrix<int, 4, 4>`.
+ * The cells live inside the object (on the stack for a local) so there is no allocation at all, every loop has a
+ * trip count known at compile time and is written out in full, and everything is `constexpr` so it can be used in
+ * constant expressions. Multiplying or adding matrices of the wrong shape does not compile instead of throwing.
+ * It has the same interface as `Matrix<T>` (`Matrix<T, dynamicSize, dynamicSize>`), so code written against
+ * `Matrix<T, R, C>` takes either
+ * @tparam T the element type
+ * @tparam R the number of rows
+ * @tparam C the number of cols
+ */
+template<class T, size_t R, size_t C>
+class Matrix {
+    static_assert(R != dynamicSize && C != dynamicSize, "A matrix is either fixed in both dimensions or in neither.");
+
+public:
+    typedef T value_type; // the element type
+    typedef T* row_t; // a row of the matrix; returned by `operator[]`
+    typedef const T* const_row_t; // read-only version of `row_t`
+    typedef MatrixView<T> view_t; // a view of the whole matrix
+    typedef MatrixView<const T> const_view_t; // read-only version of `view_t`
+
+    /**
+     * @brief Construct a new Matrix with every cell zero
+     */
+    constexpr Matrix() = default;
+
+    /**
+     * @brief Construct a new Matrix from its cells, e.g. `Matrix<int, 2, 2> m({{1, 2}, {3, 4}});`
+     * Too many rows or cols does not compile; missing ones are zero
+     * @param values the cells, row by row
+     */
+    constexpr Matrix(const T (&values)[R][C]) {
+        fixed::forEach<R * C>([&](size_t k) { cells[k] = values[k / C][k % C]; });
+    }
+
+    /**
+     * @brief Construct a new Matrix from a dynamic one of the same size (e.g. one from `MatrixReader`)
+     * @param other the matrix to copy; must be R x C
+     */
+    explicit Matrix(const Matrix<T>& other) {
+        if (other.numRows() != R || other.numCols() != C) {
+            throw std::invalid_argument("Matrix dimensions do not match the fixed size.");
+        }
+        fixed::forEach<R * C>([&](size_t k) { cells[k] = other.ptr()[k]; });
+    }
+
+    /**
+     * Copies the matrix into a dynamic `Matrix<T>`
+     * @return Matrix<T> the same cells with runtime dimensions
+     */
+    Matrix<T> toDynamic() const {
+        Matrix<T> result(R, C);
+        fixed::forEach<R * C>([&](size_t k) { result.ptr()[k] = cells[k]; });
+        return result;
+    }
+
+    /**
+     * In-place addition (Matrix<T, R, C> += Matrix<T, R, C>)
+     * @param other the matrix to add
+     * @return Matrix& reference to `this` matrix after the addition
+     */
+    constexpr Matrix& operator+=(const Matrix& other) {
+        fixed::forEach<R * C>([&](size_t k) { cells[k] += other.cells[k]; });
+        return *this;
+    }
+
+    /**
+     * In-place subtraction (Matrix<T, R, C> -= Matrix<T, R, C>)
+     * @param other the matrix to subtract
+     * @return Matrix& reference to `this` matrix after the subtraction
+     */
+    constexpr Matrix& operator-=(const Matrix& other) {
+        fixed::forEach<R * C>([&](size_t k) { cells[k] -= other.cells[k]; });
+        return *this;
+    }
+
+    /**
+     * In-place scalar multiplication; every cell is multiplied by `scalar`
+     * @param scalar the value to multiply by
+     * @return Matrix& reference to `this` matrix after the multiplication
+     */
+    constexpr Matrix& operator*=(const T& scalar) {
+        fixed::forEach<R * C>([&](size_t k) { cells[k] *= scalar; });
+        return *this;
+    }
+
+    /**
+     * In-place matrix multiplication (this = this * other); only square matrices keep their shape so only they have it
+     * @param other the matrix to multiply by
+     * @return Matrix& reference to `this` matrix after the multiplication
+     */
+    constexpr Matrix& operator*=(const Matrix& other) requires (R == C) { return *this = *this * other; }
+
+    /**
+     * Trace is the main diagonal sum (top left to bottom right); only defined for square matrices
+     * @return T the sum of the main diagonal cells
+     */
+    constexpr T trace() const {
+        static_assert(R == C, "Trace is only defined for square matrices.");
+        T sum{};
+        fixed::forEach<R>([&](size_t i) { sum += cells[i * C + i]; });
+        return sum;
+    }
+
+    /**
+     * Calculates the secondary diagonal sum (top right to bottom left); only defined for square matrices
+     * @return T the sum of the secondary diagonal cells
+     */
+    constexpr T secondaryDiagonalSum() const {
+        static_assert(R == C, "Secondary diagonal sum is only defined for square matrices.");
+        T sum{};
+        fixed::forEach<R>([&](size_t i) { sum += cells[i * C + (C - 1 - i)]; });
+        return sum;
+    }
+
+    /**
+     * Swaps two rows of the matrix; out of bound indices are ignored (like `Matrix<T>::swapRows`)
+     * @param row1 the index of the first row
+     * @param row2 the index of the second row
+     */
+    constexpr void swapRows(size_t row1, size_t row2) {
+        if (!inRowBounds(row1) || !inRowBounds(row2)) return;
+        fixed::forEach<C>([&](size_t j) { std::swap(cells[row1 * C + j], cells[row2 * C + j]); });
+    }
+
+    /**
+     * Swaps two columns of the matrix; out of bound indices are ignored (like `Matrix<T>::swapCols`)
+     * @param col1 the index of the first column
+     * @param col2 the index of the second column
+     */
+    constexpr void swapCols(size_t col1, size_t col2) {
+        if (!inColBounds(col1) || !inColBounds(col2)) return;
+        fixed::forEach<R>([&](size_t i) { std::swap(cells[i * C + col1], cells[i * C + col2]); });
+    }
+
+    /**
+     * Access operator to get a specific row of the matrix; allows for double indexing like `matrix[row][col]`.
+     * The row is checked like `Matrix<T>::operator[]`, the col is not
+     * @param row the row index to access
+     * @return row_t pointer to the first cell of the row
+     */
+    constexpr row_t operator[](size_t row) {
+        if (!inRowBounds(row)) throw std::out_of_range("Matrix row index out of range.");
+        return cells + row * C;
+    }
+    constexpr const_row_t operator[](size_t row) const {
+        if (!inRowBounds(row)) throw std::out_of_range("Matrix row index out of range.");
+        return cells + row * C;
+    }
+
+    /**
+     * Unchecked element access
+     * @param row the row of the element
+     * @param col the col of the element
+     * @return T& reference to the element
+     */
+    constexpr T& operator()(size_t row, size_t col) { return cells[row * C + col]; }
+    constexpr const T& operator()(size_t row, size_t col) const { return cells[row * C + col]; }
+
+    // views over the matrix; none of these copy any data
+    view_t view() { return view_t(cells, R, C); }
+    const_view_t view() const { return const_view_t(cells, R, C); }
+
+    static constexpr size_t numRows() { return R; } // the number of rows in the matrix
+    static constexpr size_t numCols() { return C; } // the number of cols in the matrix
+    constexpr T* ptr() { return cells; } // the raw (row-major) cells
+    constexpr const T* ptr() const { return cells; }
+
+    /**
+     * Overloaded output stream operator; prints exactly like `Matrix<T>`
+     * @param os the output stream
+     * @param m the matrix to output
+     * @return std::ostream& reference to the output stream
+     */
+    friend std::ostream& operator<<(std::ostream& os, const Matrix& m) {
+        MatrixWriter(os, MatrixLayout::Pretty).write(m.view());
+        return os;
+    }
+
+    // helper functions to check if indices are in bounds
+    static constexpr bool inRowBounds(size_t row) { return row < R; }
+    static constexpr bool inColBounds(size_t col) { return col < C; }
+
+private:
+    T cells[R * C]{}; // the cells stored row-major inside the object
+};
+
+/**
+ * Addition operator (+) => (Matrix<T, R, C> + Matrix<T, R, C>); a size mismatch does not compile
+ * @return Matrix<T, R, C> the sum
+ */
+template<class T, size_t R, size_t C> requires (R != dynamicSize)
+constexpr Matrix<T, R, C> operator+(Matrix<T, R, C> a, const Matrix<T, R, C>& b) { return a += b; }
+
+/**
+ * Subtraction operator (-) => (Matrix<T, R, C> - Matrix<T, R, C>); a size mismatch does not compile
+ * @return Matrix<T, R, C> the difference
+ */
+template<class T, size_t R, size_t C> requires (R != dynamicSize)
+constexpr Matrix<T, R, C> operator-(Matrix<T, R, C> a, const Matrix<T, R, C>& b) { return a -= b; }
+
+/**
+ * Multiplication operator (*) => (Matrix<T, R, K> * Matrix<T, K, C>); the inner sizes must match or it does not compile
+ * @return Matrix<T, R, C> the product
+ */
+template<class T, size_t R, size_t K, size_t C> requires (R != dynamicSize && C != dynamicSize)
+constexpr Matrix<T, R, C> operator*(const Matrix<T, R, K>& a, const Matrix<T, K, C>& b) {
+    Matrix<T, R, C> result;
+    fixed::forEach<R * C>([&](size_t cell) {
+        const size_t i = cell / C, j = cell % C;
+        T sum{};
+        fixed::forEach<K>([&](size_t k) { sum += a(i, k) * b(k, j); });
+        result(i, j) = sum;
+    });
+    return result;
+}
+
+/**
+ * Scalar multiplication (Matrix<T, R, C> * T and T * Matrix<T, R, C>); every cell is multiplied by `scalar`
+ * @return Matrix<T, R, C> the scaled matrix
+ */
+template<class T, size_t R, size_t C> requires (R != dynamicSize)
+constexpr Matrix<T, R, C> operator*(Matrix<T, R, C> a, const T& scalar) { return a *= scalar; }
+template<class T, size_t R, size_t C> requires (R != dynamicSize)
+constexpr Matrix<T, R, C> operator*(const T& scalar, Matrix<T, R, C> a) { return a *= scalar; }
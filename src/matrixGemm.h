@@ -0,0 +1,214 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <vector> // needed for the packing buffers
+#include <algorithm> // needed for std::min
+
+#include "matrixAllocator.h" // needed for AlignedAllocator
+#include "threadPool.h" // big products are split over threads
+
+/**
+ * Tuning knobs for the blocked matrix multiply, one specialization per element type.
+ * `MR` x `NR` is the register tile the micro-kernel keeps in accumulators so it is fixed at compile time.
+ * `MC`, `KC` and `NC` are the cache tiles (A block is MC x KC and should sit in L2, a B panel is KC x NR and should sit in L1,
+ * the packed B block is KC x NC and should sit in L3); these can be changed at runtime, e.g. `GemmConfig<double>::KC = 128;`
+ * Types without a specialization use the plain triple loop instead
+ * @tparam T the element type
+ */
+template<class T>
+struct GemmConfig {
+    static constexpr bool blocked = false; // no tuned kernel for this type
+};
+
+template<>
+struct GemmConfig<int> {
+    static constexpr bool blocked = true;
+    static constexpr size_t MR = 4, NR = 16; // 4 rows x 2 AVX2 registers of ints
+    static inline size_t MC = 128, KC = 384, NC = 4096;
+};
+
+template<>
+struct GemmConfig<float> {
+    static constexpr bool blocked = true;
+    static constexpr size_t MR = 4, NR = 16; // 4 rows x 2 AVX2 registers of floats
+    static inline size_t MC = 128, KC = 384, NC = 4096;
+};
+
+template<>
+struct GemmConfig<double> {
+    static constexpr bool blocked = true;
+    static constexpr size_t MR = 4, NR = 8; // 4 rows x 2 AVX2 registers of doubles
+    static inline size_t MC = 96, KC = 256, NC = 4096;
+};
+
+/**
+ * Namespace for the internals of the blocked multiply; the entry point is `gemm::multiply`
+ */
+namespace gemm {
+
+    // buffers the packed panels live in; kept per thread and reused between calls so a multiply does not allocate.
+    // Only safe for work that never waits on the pool: a thread waiting in `parallelFor` runs other jobs' chunks meanwhile,
+    // and one of those may start another multiply on the same thread
+    template<class T>
+    std::vector<T, AlignedAllocator<T>>& packBuffer(int which) {
+        thread_local std::vector<T, AlignedAllocator<T>> buffers[2];
+        return buffers[which];
+    }
+
+    /**
+     * Copies an `mc` x `kc` block of A into MR-row panels; each panel is stored column by column (k-major)
+     * so the micro-kernel can read it with unit stride. Short panels at the bottom are padded with zeros
+     */
+    template<class T>
+    void packA(const T* A, size_t lda, size_t mc, size_t kc, T* out) {
+        constexpr size_t MR = GemmConfig<T>::MR;
+        for (size_t i = 0; i < mc; i += MR) { // every panel of MR rows
+            size_t m = std::min(MR, mc - i); // the last panel might be short
+            for (size_t p = 0; p < kc; p++) { // walk down the k dimension
+                for (size_t r = 0; r < m; r++) *out++ = A[(i + r) * lda + p];
+                for (size_t r = m; r < MR; r++) *out++ = T{}; // zero padding
+            }
+        }
+    }
+
+    /**
+     * Copies a `kc` x `nc` block of B into NR-col panels; each panel is stored row by row (k-major).
+     * Short panels on the right are padded with zeros
+     */
+    template<class T>
+    void packB(const T* B, size_t ldb, size_t kc, size_t nc, T* out) {
+        constexpr size_t NR = GemmConfig<T>::NR;
+        for (size_t j = 0; j < nc; j += NR) { // every panel of NR cols
+            size_t n = std::min(NR, nc - j); // the last panel might be short
+            for (size_t p = 0; p < kc; p++) { // walk down the k dimension
+                const T* row = B + p * ldb + j;
+                for (size_t c = 0; c < n; c++) *out++ = row[c];
+                for (size_t c = n; c < NR; c++) *out++ = T{}; // zero padding
+            }
+        }
+    }
+
+    /**
+     * The register-blocked core: C[MR x NR] (+)= Apanel[MR x kc] * Bpanel[kc x NR].
+     * The accumulators are a fixed size local array so the compiler keeps them in registers and vectorizes the `j` loop
+     * @param m how many of the MR rows are real (the rest is padding)
+     * @param n how many of the NR cols are real (the rest is padding)
+     * @param accumulate add to C instead of overwriting it
+     */
+    template<class T>
+    void microKernel(size_t kc, const T* a, const T* b, T* C, size_t ldc, size_t m, size_t n, bool accumulate) {
+        constexpr size_t MR = GemmConfig<T>::MR, NR = GemmConfig<T>::NR;
+        T acc[MR][NR] = {}; // the register tile
+
+        for (size_t p = 0; p < kc; p++) { // one rank-1 update per step of k
+            for (size_t i = 0; i < MR; i++) {
+                T ai = a[p * MR + i];
+                for (size_t j = 0; j < NR; j++) {
+                    acc[i][j] += ai * b[p * NR + j];
+                }
+            }
+        }
+
+        // write the tile back, only the part that is inside C
+        for (size_t i = 0; i < m; i++) {
+            T* c = C + i * ldc;
+            if (accumulate) for (size_t j = 0; j < n; j++) c[j] += acc[i][j];
+            else for (size_t j = 0; j < n; j++) c[j] = acc[i][j];
+        }
+    }
+
+    /**
+     * Blocked multiply of raw row-major buffers: C (+)= A * B
+     * @param A pointer to the M x K left matrix with leading dimension `lda`
+     * @param B pointer to the K x N right matrix with leading dimension `ldb`
+     * @param C pointer to the M x N result with leading dimension `ldc`
+     * @param accumulate add the product to what is already in C instead of overwriting it
+     */
+    template<class T>
+    void multiply(const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc,
+                  size_t M, size_t N, size_t K, bool accumulate = false) {
+        if (M == 0 || N == 0) return; // nothing to write
+        if (K == 0) { // empty sum; the product is all zeros
+            if (!accumulate) for (size_t i = 0; i < M; i++) std::fill(C + i * ldc, C + i * ldc + N, T{});
+            return;
+        }
+
+        if constexpr (!GemmConfig<T>::blocked) {
+            // no tuned kernel for this type so we use the plain loop, in i-k-j order so B and C are walked along their rows;
+            // rows of C are independent so big products split them over threads
+            const bool parallel = 2.0 * M * N * K >= static_cast<double>(ThreadPool::minParallelFlops);
+            parallelFor(0, M, parallel ? 1 : M, [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; i++) {
+                    T* c = C + i * ldc;
+                    if (!accumulate) std::fill(c, c + N, T{});
+                    for (size_t k = 0; k < K; k++) {
+                        const T aik = A[i * lda + k];
+                        const T* b = B + k * ldb;
+                        for (size_t j = 0; j < N; j++) c[j] += aik * b[j];
+                    }
+                }
+            });
+        } else {
+            typedef GemmConfig<T> cfg;
+            constexpr size_t MR = cfg::MR, NR = cfg::NR;
+            // only big products are split over threads; small ones never touch the pool
+            const bool parallel = 2.0 * M * N * K >= static_cast<double>(ThreadPool::minParallelFlops);
+            const size_t threads = parallel ? ThreadPool::instance().size() : 1;
+
+            // round the cache tiles to whole register tiles
+            size_t MC = std::max(MR, cfg::MC / MR * MR);
+            const size_t NC = std::max(NR, cfg::NC / NR * NR);
+            const size_t KC = std::max<size_t>(1, cfg::KC);
+            // make the row blocks small enough that every thread gets at least one
+            if (threads > 1) MC = std::min(MC, ((M + threads - 1) / threads + MR - 1) / MR * MR);
+
+            // the packed B block is shared by every thread, each thread packs its own A blocks.
+            // A parallel multiply owns its B buffer: while this thread waits for the workers it may run a chunk of another job
+            // that multiplies too, which would repack (or reallocate) a per thread buffer the workers are still reading.
+            // A chunk never waits, so the per thread A buffers are safe; so is B for a serial multiply, which never waits either
+            std::vector<T, AlignedAllocator<T>> ownB;
+            auto& bufB = threads > 1 ? ownB : packBuffer<T>(1);
+            // `resize` only allocates the first time (or when the tiles grow) since we never shrink the buffers
+            const size_t needA = (std::min(MC, M) + MR - 1) / MR * MR * std::min(KC, K);
+            const size_t needB = (std::min(NC, N) + NR - 1) / NR * NR * std::min(KC, K);
+            if (bufB.size() < needB) bufB.resize(needB);
+            T* packedB = bufB.data();
+
+            for (size_t jc = 0; jc < N; jc += NC) { // block of cols of B and C
+                const size_t nc = std::min(NC, N - jc);
+                for (size_t pc = 0; pc < K; pc += KC) { // block of the shared dimension
+                    const size_t kc = std::min(KC, K - pc);
+                    // after the first k block every tile has to add to what the earlier blocks wrote
+                    const bool acc = accumulate || pc > 0;
+
+                    // pack B one NR-wide panel at a time; panel `p` starts at `p * NR * kc` in the buffer
+                    const size_t panels = (nc + NR - 1) / NR;
+                    parallelFor(0, panels, parallel ? 1 : panels, [&](size_t lo, size_t hi) {
+                        packB(B + pc * ldb + jc + lo * NR, ldb, kc, std::min(nc, hi * NR) - lo * NR, packedB + lo * NR * kc);
+                    });
+
+                    // every block of rows of A and C is independent, so those are what the threads share out
+                    const size_t blocks = (M + MC - 1) / MC;
+                    parallelFor(0, blocks, parallel ? 1 : blocks, [&](size_t lo, size_t hi) {
+                        auto& bufA = packBuffer<T>(0); // this thread's own A buffer
+                        if (bufA.size() < needA) bufA.resize(needA);
+
+                        for (size_t blk = lo; blk < hi; blk++) {
+                            const size_t ic = blk * MC;
+                            const size_t mc = std::min(MC, M - ic);
+                            packA(A + ic * lda + pc, lda, mc, kc, bufA.data());
+
+                            for (size_t jr = 0; jr < nc; jr += NR) { // every register tile in the block
+                                for (size_t ir = 0; ir < mc; ir += MR) {
+                                    microKernel<T>(kc, bufA.data() + ir * kc, packedB + jr * kc,
+                                                   C + (ic + ir) * ldc + jc + jr, ldc,
+                                                   std::min(MR, mc - ir), std::min(NR, nc - jr), acc);
+                                }
+                            }
+                        }
+                    });
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <cstring> // needed for std::memchr and std::memmove
+#include <charconv> // needed for std::from_chars
+#include <fstream> // needed to read the file
+#include <sstream> // needed for the fallback parser
+#include <string> // needed for std::string
+#include <vector> // needed for the read buffer
+#include <type_traits> // needed to pick the fast path
+
+/**
+ * Reads a text file a line at a time out of one big reusable buffer.
+ * Each refill is a single large read straight from the file, and the lines handed out point into the buffer,
+ * so there is no `std::string` per line and no copying. It behaves like `std::getline`: the last line does not
+ * need a trailing newline, and reading past the end fails
+ */
+class LineScanner {
+public:
+    // how much is read from the file at a time; the buffer grows past this only if a single line is longer
+    static constexpr size_t CHUNK_SIZE = size_t(1) << 20; // 1 MiB
+
+    /**
+     * @brief Construct a new LineScanner
+     * @param _file the (already opened) file to read from; must outlive the scanner
+     */
+    explicit LineScanner(std::ifstream& _file) : file(_file), buffer(CHUNK_SIZE) {}
+
+    /**
+     * Gets the next line, without its line ending
+     * @param begin set to the first character of the line
+     * @param end set to one past the last character of the line
+     * @return true if there was a line, false at the end of the file (just like `std::getline` failing)
+     */
+    bool nextLine(const char*& begin, const char*& end) {
+        while (true) {
+            // is there a whole line waiting in the buffer?
+            const char* start = buffer.data() + pos;
+            const char* newline = static_cast<const char*>(std::memchr(start, '\n', filled - pos));
+            if (newline) {
+                begin = start;
+                end = newline;
+                pos = static_cast<size_t>(newline - buffer.data()) + 1; // skip the '\n'
+                return true;
+            }
+
+            if (eof) { // no more data coming; whatever is left is the last line (if there is anything)
+                if (pos == filled) return false;
+                begin = start;
+                end = buffer.data() + filled;
+                pos = filled;
+                return true;
+            }
+
+            refill();
+        }
+    }
+
+private:
+    // moves the unfinished line to the front of the buffer and reads the next chunk behind it
+    void refill() {
+        const size_t left = filled - pos;
+        if (left > 0 && pos > 0) std::memmove(buffer.data(), buffer.data() + pos, left);
+        pos = 0;
+        filled = left;
+        if (buffer.size() - filled < CHUNK_SIZE / 2) buffer.resize(buffer.size() * 2); // a really long line
+
+        std::streamsize got = file.rdbuf()->sgetn(buffer.data() + filled, static_cast<std::streamsize>(buffer.size() - filled));
+        if (got <= 0) eof = true;
+        else filled += static_cast<size_t>(got);
+    }
+
+    std::ifstream& file; // where the data comes from
+    std::vector<char> buffer; // holds the current chunk
+    size_t pos = 0; // start of the first line not handed out yet
+    size_t filled = 0; // how much of `buffer` holds data
+    bool eof = false; // the file has no more data
+};
+
+/**
+ * Parsing helpers for one line of numbers
+ */
+namespace parse {
+
+    // the types `std::from_chars` handles the same way `operator>>` does (`char` types are read as characters by `>>` and `bool` as 0/1)
+    template<class T>
+    inline constexpr bool fastPath = (std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char> &&
+                                      !std::is_same_v<T, signed char> && !std::is_same_v<T, unsigned char>) ||
+                                     std::is_floating_point_v<T>;
+
+    inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+
+    /**
+     * Reads the next number on the line into `out`; skips leading whitespace like `operator>>` does
+     * @param p the current position in the line; moved past the number on success
+     * @param end the end of the line
+     * @param out where the number goes
+     * @return true if a number was read, false if the line ran out or the text is not a valid `T`
+     */
+    template<class T>
+    bool value(const char*& p, const char* end, T& out) {
+        while (p != end && isSpace(*p)) p++;
+        if (p == end) return false;
+        if (*p == '+' && p + 1 != end && !isSpace(p[1])) p++; // `>>` accepts a leading '+', `from_chars` does not
+
+        std::from_chars_result r;
+        if constexpr (std::is_floating_point_v<T>) r = std::from_chars(p, end, out, std::chars_format::general);
+        else r = std::from_chars(p, end, out);
+        if (r.ec != std::errc()) return false; // not a number or out of range for `T`
+        p = r.ptr;
+        return true;
+    }
+
+    /**
+     * Reads `n` values of one line into `out`
+     * @return true if the line held at least `n` valid values (anything after them is ignored)
+     */
+    template<class T>
+    bool row(const char* begin, const char* end, T* out, size_t n) {
+        if constexpr (fastPath<T>) {
+            for (size_t j = 0; j < n; j++) {
+                if (!value(begin, end, out[j])) return false;
+            }
+        } else {
+            // any other type goes through its own `operator>>`
+            std::istringstream iss(std::string(begin, end));
+            for (size_t j = 0; j < n; j++) {
+                if (!(iss >> out[j])) return false;
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,161 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <vector> // needed for the permutation indices
+#include <numeric> // needed for std::iota
+#include <algorithm> // needed for std::copy
+#include <utility> // needed for std::swap and std::move
+#include <stdexcept> // needed for throwing errors
+#include <iostream> // needed for printing
+
+#include "matrix.h" // the matrix being permuted
+#include "matrixWriter.h" // prints the permuted matrix without building it
+#include "threadPool.h" // splits materializing over threads
+
+/**
+ * A matrix whose rows and cols are reordered lazily: swaps only swap two entries of an index list, so each one is O(1)
+ * however big the matrix is, and cell (i, j) is `unpermuted()(rowOrder()[i], colOrder()[j])`.
+ * Trace, secondary diagonal sum and printing read through the indices, so they never move the data either.
+ * `materialize()` (or `apply()`) builds the reordered matrix in one pass once it is actually needed as a `Matrix<T>`:
+ * each row is copied from its source row, gathering through the col order only if any col has moved
+ *
+ *     PermutedMatrix<int> p(std::move(m));
+ *     for (...) p.swapCols(a, b); // O(1) each
+ *     Matrix<int> result = p.materialize(); // one O(N^2) pass
+ *
+ * @tparam T the element type
+ */
+template<class T>
+class PermutedMatrix {
+public:
+    typedef T value_type; // the element type
+
+    /**
+     * @brief Construct a new PermutedMatrix that starts in the matrix's own order
+     * @param _base the matrix to permute; pass it with `std::move` to not copy it
+     */
+    explicit PermutedMatrix(Matrix<T> _base) : base(std::move(_base)) { reset(); }
+
+    size_t numRows() const { return base.numRows(); } // the number of rows
+    size_t numCols() const { return base.numCols(); } // the number of cols
+    const Matrix<T>& unpermuted() const { return base; } // the data in its stored order
+    const std::vector<size_t>& rowOrder() const { return rowIndex; } // row i is row `rowOrder()[i]` of `unpermuted()`
+    const std::vector<size_t>& colOrder() const { return colIndex; } // col j is col `colOrder()[j]` of `unpermuted()`
+
+    /**
+     * Unchecked element access through the permutation
+     * @param row the row of the element
+     * @param col the col of the element
+     * @return T& reference to the element
+     */
+    T& operator()(size_t row, size_t col) { return base(rowIndex[row], colIndex[col]); }
+    const T& operator()(size_t row, size_t col) const { return base(rowIndex[row], colIndex[col]); }
+
+    /**
+     * Swaps two rows in O(1); out of bound indices are ignored, like `Matrix<T>::swapRows`
+     * @param row1 the index of the first row
+     * @param row2 the index of the second row
+     */
+    void swapRows(size_t row1, size_t row2) {
+        if (!base.inRowBounds(row1) || !base.inRowBounds(row2)) return;
+        std::swap(rowIndex[row1], rowIndex[row2]);
+    }
+
+    /**
+     * Swaps two cols in O(1); out of bound indices are ignored, like `Matrix<T>::swapCols`
+     * @param col1 the index of the first col
+     * @param col2 the index of the second col
+     */
+    void swapCols(size_t col1, size_t col2) {
+        if (!base.inColBounds(col1) || !base.inColBounds(col2)) return;
+        std::swap(colIndex[col1], colIndex[col2]);
+    }
+
+    /**
+     * Trace is the main diagonal sum (top left to bottom right), read through the permutation
+     * @return T the sum of the main diagonal cells
+     */
+    T trace() const {
+        if (numRows() != numCols()) {
+            throw std::invalid_argument("Trace is only defined for square matrices.");
+        }
+        T sum{};
+        for (size_t i = 0; i < numRows(); i++) sum += (*this)(i, i);
+        return sum;
+    }
+
+    /**
+     * Calculates the secondary diagonal sum (top right to bottom left), read through the permutation
+     * @return T the sum of the secondary diagonal cells
+     */
+    T secondaryDiagonalSum() const {
+        if (numRows() != numCols()) {
+            throw std::invalid_argument("Secondary diagonal sum is only defined for square matrices.");
+        }
+        T sum{};
+        for (size_t i = 0; i < numRows(); i++) sum += (*this)(i, numCols() - 1 - i);
+        return sum;
+    }
+
+    /**
+     * Builds the reordered matrix into a matrix the caller already owns; only allocates if `out` has never been that big
+     * @param out the destination
+     */
+    void materializeInto(Matrix<T>& out) const {
+        out.resize(numRows(), numCols());
+        const size_t n = numCols();
+        bool colsMoved = false; // with the cols in order every row is one straight copy
+        for (size_t j = 0; j < n && !colsMoved; j++) colsMoved = colIndex[j] != j;
+
+        parallelFor(0, numRows(), std::max<size_t>(1, ThreadPool::minParallelElements / std::max<size_t>(n, 1)), [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; i++) {
+                const T* src = base.ptr() + rowIndex[i] * n;
+                T* dst = out.ptr() + i * n;
+                if (!colsMoved) std::copy(src, src + n, dst);
+                else for (size_t j = 0; j < n; j++) dst[j] = src[colIndex[j]];
+            }
+        });
+    }
+
+    /**
+     * Builds the reordered matrix
+     * @return Matrix<T> the matrix with every swap applied
+     */
+    Matrix<T> materialize() const {
+        Matrix<T> result(0, 0);
+        materializeInto(result);
+        return result;
+    }
+
+    /**
+     * Moves the data into the current order and starts over from the identity permutation
+     */
+    void apply() {
+        base = materialize();
+        reset();
+    }
+
+    /**
+     * Overloaded output stream operator so the permuted matrix prints like a `Matrix<T>`, without building it
+     * @param os the output stream
+     * @param m the matrix to output
+     * @return std::ostream& reference to the output stream
+     */
+    friend std::ostream& operator<<(std::ostream& os, const PermutedMatrix& m) {
+        MatrixWriter(os, MatrixLayout::Pretty).writeCells(m);
+        return os;
+    }
+
+private:
+    // back to the identity permutation
+    void reset() {
+        rowIndex.resize(base.numRows());
+        colIndex.resize(base.numCols());
+        std::iota(rowIndex.begin(), rowIndex.end(), size_t(0));
+        std::iota(colIndex.begin(), colIndex.end(), size_t(0));
+    }
+
+    Matrix<T> base; // the data, in its stored order
+    std::vector<size_t> rowIndex; // the row order
+    std::vector<size_t> colIndex; // the col order
+};
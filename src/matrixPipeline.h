@@ -0,0 +1,485 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <cstdlib> // needed for std::strtoul, std::strtod, EXIT_SUCCESS and EXIT_FAILURE
+#include <cerrno> // needed to catch counts too big for `strtoul`
+#include <cctype> // needed for std::isdigit
+#include <string> // needed for std::string
+#include <vector> // needed for the op list and the output parts
+#include <deque> // needed for the output queue
+#include <sstream> // needed to format each chunk of results
+#include <fstream> // needed for the output file
+#include <iostream> // needed for std::cout and std::cerr
+#include <chrono> // needed for timing
+#include <thread> // needed for the writer thread
+#include <mutex> // needed to guard the output queue
+#include <condition_variable> // needed to wait on the output queue
+#include <exception> // needed to carry write errors back
+#include <stdexcept> // needed for throwing errors
+#include <algorithm> // needed for std::min, std::max and std::clamp
+#include <filesystem> // needed for the input size
+#include <optional> // needed for the optional writer and output pipe
+#include <utility> // needed for std::as_const
+
+#include "matrix.h" // the matrices being worked on
+#include "matrixStream.h" // `BatchReader` for text input
+#include "matrixBinary.h" // `MappedMatrixFile` for binary input
+#include "matrixWriter.h" // formats the results
+#include "threadPool.h" // splits every batch over threads
+
+/**
+ * The non-interactive mode of `main`: applies a list of operations to every matrix (or every pair of matrices) in a file
+ * and reports the throughput. Three stages run at once: a background thread parses the next batch (`BatchReader`; a binary
+ * file is memory mapped instead), the current batch is worked on by the thread pool, and a writer thread prints the results
+ * of the previous batch.
+ *
+ *     main.out --batch matrices.txt --ops add,multiply,trace,swapRows:0:1 [--out results.txt] [--type int] [--batch-size 256]
+ *
+ * If the ops include `add` or `multiply` the matrices are taken in pairs (1 and 2, 3 and 4, ...) and every other op applies
+ * to both matrices of the pair; otherwise every op applies to each matrix. Results are printed the same way the interactive
+ * mode prints them
+ */
+namespace pipeline {
+
+    // what can be asked for with `--ops`
+    enum class OpKind { Add, Multiply, Trace, SwapRows, SwapCols, Update };
+
+    // one entry of `--ops`, with its arguments
+    struct Op {
+        OpKind kind;
+        size_t first = 0, second = 0; // the two indices of a swap, or the row and col of an update
+        double value = 0; // the new value of an update
+    };
+
+    // everything the command line can set
+    struct Options {
+        std::string input; // the matrix file; text or binary (picked from its first bytes)
+        std::string output = "-"; // where the results go; `-` is stdout
+        std::string type = "int"; // the element type: int, long, float or double
+        std::vector<Op> ops;
+        size_t batchSize = 0; // matrices per batch; 0 picks it from the matrix size (see `batchSizeFor`)
+        size_t threads = 0; // 0 keeps the pool's default (`MATRIX_THREADS` or one per core)
+        bool quiet = false; // compute but do not print the results
+    };
+
+    constexpr size_t BATCH_BYTES = size_t(32) << 20; // without `--batch-size` a batch holds about this many bytes of matrices
+    constexpr size_t MAX_BATCH = 1024; // and at most this many, so small matrices still come out a batch at a time
+
+    /**
+     * How many matrices go in one batch
+     * @param requested the `--batch-size` given, or 0 to fill about `BATCH_BYTES`
+     * @param rows the rows of every matrix in the file
+     * @param cols the cols of every matrix in the file
+     * @return size_t at least 1
+     */
+    template<class T>
+    size_t batchSizeFor(size_t requested, size_t rows, size_t cols) {
+        if (requested > 0) return requested;
+        if (rows == 0 || cols == 0) return MAX_BATCH;
+        if (cols > BATCH_BYTES / sizeof(T) / rows) return 1; // one matrix is already over the budget (or N * N overflows)
+        return std::clamp<size_t>(BATCH_BYTES / (rows * cols * sizeof(T)), 1, MAX_BATCH);
+    }
+
+    inline const char* usage() {
+        return "Usage: main.out --batch <file> --ops <op,op,...> [--out <file>|-] [--type int|long|float|double]\n"
+               "                [--batch-size <n>] [--threads <n>] [--quiet]\n"
+               "  --batch-size defaults to as many matrices as fit in 32 MB (at most 1024)\n"
+               "  ops: add, multiply, trace, swapRows:<r1>:<r2>, swapCols:<c1>:<c2>, update:<row>:<col>:<value>\n"
+               "  with no arguments main.out runs interactively\n";
+    }
+
+    /**
+     * Parses an `--ops` list like `add,trace,swapRows:0:1`
+     * @param list the comma separated ops
+     * @return std::vector<Op> the ops in order
+     */
+    inline std::vector<Op> parseOps(const std::string& list) {
+        std::vector<Op> ops;
+        std::stringstream items(list);
+        std::string item;
+        while (std::getline(items, item, ',')) {
+            std::vector<std::string> parts;
+            std::stringstream fields(item);
+            std::string field;
+            while (std::getline(fields, field, ':')) parts.push_back(field);
+            if (parts.empty()) continue;
+
+            auto index = [&](size_t k) {
+                char* end = nullptr;
+                size_t v = std::strtoul(parts[k].c_str(), &end, 10);
+                if (parts[k].empty() || *end != '\0') throw std::invalid_argument("Bad index in op: " + item);
+                return v;
+            };
+            const std::string& name = parts[0];
+            Op op{OpKind::Add};
+            size_t arguments = 0;
+            if (name == "add") op.kind = OpKind::Add;
+            else if (name == "multiply") op.kind = OpKind::Multiply;
+            else if (name == "trace") op.kind = OpKind::Trace;
+            else if (name == "swapRows") { op.kind = OpKind::SwapRows; arguments = 2; }
+            else if (name == "swapCols") { op.kind = OpKind::SwapCols; arguments = 2; }
+            else if (name == "update") { op.kind = OpKind::Update; arguments = 3; }
+            else throw std::invalid_argument("Unknown op: " + name);
+
+            if (parts.size() != arguments + 1) throw std::invalid_argument("Wrong number of arguments for op: " + item);
+            if (arguments >= 2) {
+                op.first = index(1);
+                op.second = index(2);
+            }
+            if (arguments == 3) {
+                char* end = nullptr;
+                op.value = std::strtod(parts[3].c_str(), &end);
+                if (parts[3].empty() || *end != '\0') throw std::invalid_argument("Bad value in op: " + item);
+            }
+            ops.push_back(op);
+        }
+        if (ops.empty()) throw std::invalid_argument("No ops given.");
+        return ops;
+    }
+
+    /**
+     * Parses the command line of the batch mode
+     * @return Options the settings
+     */
+    inline Options parseArgs(int argc, char** argv) {
+        Options options;
+        // a count like `--threads 4`: all digits and above 0 (`strtoul` alone would take `abc` as 0 and wrap `-1` around)
+        auto count = [](const std::string& flag, const std::string& value) {
+            char* end = nullptr;
+            errno = 0;
+            size_t v = std::strtoul(value.c_str(), &end, 10);
+            if (value.empty() || !std::isdigit(static_cast<unsigned char>(value[0])) || *end != '\0' || errno == ERANGE || v == 0)
+                throw std::invalid_argument("Bad value for " + flag + ": " + value + " (must be a whole number above 0)");
+            return v;
+        };
+        for (int i = 1; i < argc; i++) {
+            const std::string flag = argv[i];
+            if (flag == "--quiet") {
+                options.quiet = true;
+                continue;
+            }
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + flag);
+            const std::string value = argv[++i];
+            if (flag == "--batch") options.input = value;
+            else if (flag == "--ops") options.ops = parseOps(value);
+            else if (flag == "--out") options.output = value;
+            else if (flag == "--type") options.type = value;
+            else if (flag == "--batch-size") options.batchSize = count(flag, value);
+            else if (flag == "--threads") options.threads = count(flag, value);
+            else throw std::invalid_argument("Unknown option: " + flag);
+        }
+        if (options.input.empty()) throw std::invalid_argument("No input file given (--batch <file>).");
+        if (options.ops.empty()) throw std::invalid_argument("No ops given (--ops <op,op,...>).");
+        return options;
+    }
+
+    /**
+     * The writer stage: a thread that writes finished batches of text in the order they were handed over,
+     * so formatting the next batch does not wait on the output. At most `depth` batches wait in the queue
+     */
+    class OutputPipe {
+    public:
+        OutputPipe(std::ostream& _os, size_t _depth = 2) : os(_os), depth(_depth), worker(&OutputPipe::drain, this) {}
+
+        OutputPipe(const OutputPipe&) = delete; // the thread points back at the pipe
+        OutputPipe& operator=(const OutputPipe&) = delete;
+
+        ~OutputPipe() {
+            try { finish(); } catch (...) {} // a destructor must not throw; call `finish()` yourself to see errors
+        }
+
+        /**
+         * Queues one batch of text; waits if the writer is `depth` batches behind
+         * @param parts the text, in order
+         */
+        void push(std::vector<std::string>&& parts) {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return queue.size() < depth || error; });
+            if (error) std::rethrow_exception(error);
+            queue.push_back(std::move(parts));
+            changed.notify_all();
+        }
+
+        /**
+         * Writes everything still queued and stops the thread; throws if a write failed
+         */
+        void finish() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (done) return;
+                done = true;
+            }
+            changed.notify_all();
+            worker.join();
+            os.flush();
+            if (error) std::rethrow_exception(error);
+        }
+
+        size_t bytes() const { return written; } // bytes written so far; only exact after `finish()`
+
+    private:
+        void drain() {
+            for (;;) {
+                std::vector<std::string> parts;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&] { return !queue.empty() || done; });
+                    if (queue.empty()) return; // done and nothing left
+                    parts = std::move(queue.front());
+                    queue.pop_front();
+                }
+                changed.notify_all(); // room for the next batch
+                for (const std::string& p : parts) {
+                    os.write(p.data(), static_cast<std::streamsize>(p.size()));
+                    written += p.size();
+                }
+                if (!os) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    error = std::make_exception_ptr(std::runtime_error("Could not write the results."));
+                    changed.notify_all();
+                    return;
+                }
+            }
+        }
+
+        std::ostream& os;
+        size_t depth;
+        std::deque<std::vector<std::string>> queue; // batches waiting to be written
+        bool done = false; // no more batches are coming
+        std::exception_ptr error; // why writing stopped, if it did
+        size_t written = 0; // only touched by the writer thread until it is joined
+        std::mutex mutex; // guards `queue`, `done` and `error`
+        std::condition_variable changed;
+        std::thread worker; // last, so everything it uses exists before it starts
+    };
+
+    // true if the ops work on pairs of matrices
+    inline bool pairwise(const std::vector<Op>& ops) {
+        for (const Op& op : ops)
+            if (op.kind == OpKind::Add || op.kind == OpKind::Multiply) return true;
+        return false;
+    }
+
+    /**
+     * One matrix the ops work on. It is read through `view`; a matrix of a mapped binary file is only copied (into `spare`)
+     * the first time an op changes it, so adds, multiplies and traces read the mapping in place
+     */
+    template<class T>
+    struct Operand {
+        MatrixView<const T> view; // the cells as they are now
+        Matrix<T>* owned = nullptr; // the matrix behind `view` if it may be changed, nullptr while it is read-only
+        Matrix<T>* spare = nullptr; // where a read-only matrix is copied to before it is changed
+
+        // the matrix to change; copies a read-only one first
+        Matrix<T>& writable() {
+            if (!owned) {
+                spare->resize(view.numRows(), view.numCols());
+                for (size_t i = 0; i < view.numRows(); i++) std::copy(&view(i, 0), &view(i, 0) + view.numCols(), &(*spare)(i, 0));
+                owned = spare;
+                view = std::as_const(*spare).view();
+            }
+            return *owned;
+        }
+    };
+
+    /**
+     * Runs every op on one matrix or one pair and formats the results
+     * @param ops the ops
+     * @param a the (first) matrix; changed by the swaps and updates
+     * @param b the second matrix of a pair, or nullptr
+     * @param index the 1 based position of `a` in the file
+     * @param out where the text goes, or nullptr to only compute
+     * @param result scratch for sums and products; reused so steady state does not allocate
+     */
+    template<class T>
+    void apply(const std::vector<Op>& ops, Operand<T>& a, Operand<T>* b, size_t index, std::ostream* out, Matrix<T>& result) {
+        std::optional<MatrixWriter> writer;
+        if (out) {
+            if (b) *out << "Matrices " << index << " and " << index + 1 << ":\n";
+            else *out << "Matrix " << index << ":\n";
+            writer.emplace(*out, MatrixLayout::Pretty);
+        }
+        // text goes straight to `out`, so whatever the writer holds has to go first to keep the order
+        auto text = [&]() -> std::ostream& { writer->flush(); return *out; };
+        auto print = [&](MatrixView<const T> m) { writer->write(m); writer->flush(); *out << '\n'; };
+
+        Operand<T>* both[2] = {&a, b};
+        for (const Op& op : ops) {
+            try {
+                switch (op.kind) {
+                case OpKind::Add:
+                    result = a.view + b->view;
+                    if (out) { text() << "add:\n"; print(std::as_const(result).view()); }
+                    break;
+                case OpKind::Multiply:
+                    multiplyInto(result, a.view, b->view);
+                    if (out) { text() << "multiply:\n"; print(std::as_const(result).view()); }
+                    break;
+                case OpKind::Trace:
+                    for (Operand<T>* m : both) {
+                        if (!m) continue;
+                        const T main = m->view.trace(), secondary = m->view.secondaryDiagonalSum();
+                        if (out) text() << "Main Diagonal:" << main << "\nSecondary Diagonal:" << secondary << '\n';
+                    }
+                    break;
+                case OpKind::SwapRows:
+                case OpKind::SwapCols:
+                    for (Operand<T>* m : both) {
+                        if (!m) continue;
+                        const bool rows = op.kind == OpKind::SwapRows;
+                        const size_t size = rows ? m->view.numRows() : m->view.numCols();
+                        if (op.first >= size || op.second >= size) {
+                            if (out) text() << (rows ? "Row" : "Column") << " indices out of bounds.\n";
+                            continue;
+                        }
+                        if (rows) m->writable().swapRows(op.first, op.second);
+                        else m->writable().swapCols(op.first, op.second);
+                        if (out) print(m->view);
+                    }
+                    break;
+                case OpKind::Update:
+                    for (Operand<T>* m : both) {
+                        if (!m) continue;
+                        if (op.first >= m->view.numRows() || op.second >= m->view.numCols()) {
+                            if (out) text() << "Row or column index out of bounds.\n";
+                            continue;
+                        }
+                        m->writable()(op.first, op.second) = static_cast<T>(op.value);
+                        if (out) print(m->view);
+                    }
+                    break;
+                }
+            } catch (const std::exception& e) { // e.g. a non-square matrix from a binary file; report it and go on
+                if (out) text() << "error: " << e.what() << '\n';
+            }
+        }
+    }
+
+    // what a run did
+    struct Report {
+        size_t matrices = 0; // matrices read
+        size_t units = 0; // matrices or pairs the ops ran on
+        size_t unpaired = 0; // a last matrix without a partner (pairwise ops only)
+        size_t outputBytes = 0;
+        double seconds = 0;
+    };
+
+    /**
+     * Runs the ops over one batch on the thread pool and hands the text to the writer
+     * @param count how many matrices are in the batch
+     * @param get gives matrix `k` of the batch as an `Operand<T>`, called as `get(k, spare)`; `spare` is a buffer owned by
+     *            the chunk for a read-only matrix to be copied into if an op changes it
+     */
+    template<class T, class Get>
+    void runBatch(const Options& options, bool pairs, size_t first, size_t count, Get&& get, OutputPipe* pipe, Report& report) {
+        const size_t per = pairs ? 2 : 1;
+        const size_t units = count / per;
+        report.matrices += count;
+        report.units += units;
+        report.unpaired += count - units * per;
+
+        std::vector<std::string> parts(units); // the text of a chunk goes at the index of its first unit
+        parallelFor(0, units, std::max<size_t>(1, 64 / options.ops.size()), [&](size_t lo, size_t hi) {
+            // a big multiply splits itself over the pool from inside this chunk, and while it waits this thread may run another
+            // chunk; so scratch is owned by the chunk, not the thread (the kernels own the buffers they share the same way)
+            Matrix<T> result(0, 0), spares[2] = {Matrix<T>(0, 0), Matrix<T>(0, 0)};
+            std::ostringstream text;
+            for (size_t u = lo; u < hi; u++) {
+                std::optional<Operand<T>> b;
+                Operand<T> a = get(u * per, spares[0]);
+                if (pairs) b = get(u * per + 1, spares[1]);
+                apply(options.ops, a, b ? &*b : nullptr, first + u * per + 1, pipe ? &text : nullptr, result);
+            }
+            if (pipe) parts[lo] = std::move(text).str();
+        });
+        if (pipe) pipe->push(std::move(parts));
+    }
+
+    /**
+     * Reads the whole input in batches and runs the ops over it
+     * @tparam T the element type
+     * @return Report the counts and the time taken
+     */
+    template<class T>
+    Report run(const Options& options, std::ostream* out) {
+        const bool pairs = pairwise(options.ops);
+        // pairs never straddle two batches, since every batch but the last is full
+        auto even = [&](size_t size) { return pairs ? (size + 1) / 2 * 2 : size; };
+        std::optional<OutputPipe> pipe;
+        if (out) pipe.emplace(*out);
+
+        Report report;
+        const auto start = std::chrono::steady_clock::now();
+        if (binfmt::isBinaryFile(options.input)) {
+            // the mapping is read in place; a matrix is only copied (into the chunk's spare) if a swap or update changes it
+            MappedMatrixFile<T> file(options.input);
+            const size_t batchSize = even(batchSizeFor<T>(options.batchSize, file.numRows(), file.numCols()));
+            for (size_t first = 0; first < file.size(); first += batchSize) {
+                const size_t count = std::min(batchSize, file.size() - first);
+                runBatch<T>(options, pairs, first, count, [&](size_t k, Matrix<T>& spare) {
+                    return Operand<T>{file[first + k], nullptr, &spare};
+                }, pipe ? &*pipe : nullptr, report);
+            }
+        } else {
+            size_t n = 0; // the N of the file, read up front when the batch size has to be picked from it
+            if (options.batchSize == 0) n = MatrixStream<T>(options.input).size();
+            BatchReader<T> reader(options.input, even(batchSizeFor<T>(options.batchSize, n, n))); // parses the next batch while this one is worked on
+            size_t first = 0;
+            while (auto batch = reader.next()) {
+                runBatch<T>(options, pairs, first, batch.size(), [&](size_t k, Matrix<T>&) {
+                    return Operand<T>{std::as_const(batch[k]).view(), &batch[k], nullptr}; // the batch's own matrices may change
+                }, pipe ? &*pipe : nullptr, report);
+                first += batch.size();
+            }
+        }
+        if (pipe) {
+            pipe->finish();
+            report.outputBytes = pipe->bytes();
+        }
+        report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return report;
+    }
+
+    /**
+     * The batch mode's entry point: parses the command line, runs the job and prints the throughput to stderr
+     * @return int the exit status
+     */
+    inline int main(int argc, char** argv) {
+        try {
+            Options options = parseArgs(argc, argv);
+            if (options.threads > 0) ThreadPool::setThreadCount(options.threads);
+
+            std::ofstream file;
+            std::ostream* out = nullptr;
+            if (!options.quiet) {
+                if (options.output == "-") {
+                    out = &std::cout;
+                } else {
+                    file.open(options.output, std::ios::binary);
+                    if (!file.is_open()) throw std::runtime_error("Could not open file: " + options.output);
+                    out = &file;
+                }
+            }
+
+            Report report;
+            if (options.type == "int") report = run<int>(options, out);
+            else if (options.type == "long") report = run<long>(options, out);
+            else if (options.type == "float") report = run<float>(options, out);
+            else if (options.type == "double") report = run<double>(options, out);
+            else throw std::invalid_argument("Unknown type: " + options.type);
+
+            std::error_code ec;
+            const double inputBytes = static_cast<double>(std::filesystem::file_size(options.input, ec));
+            const double seconds = std::max(report.seconds, 1e-9);
+            std::cerr << report.matrices << " matrices (" << report.units << (pairwise(options.ops) ? " pairs" : " matrices")
+                      << " x " << options.ops.size() << " ops) in " << report.seconds * 1e3 << " ms: "
+                      << report.matrices / seconds << " matrices/s, " << (ec ? 0.0 : inputBytes / seconds / 1e6) << " MB/s in, "
+                      << report.outputBytes / seconds / 1e6 << " MB/s out, " << ThreadPool::instance().size() << " threads\n";
+            if (report.unpaired) std::cerr << "the last matrix had no partner and was skipped\n";
+            return EXIT_SUCCESS;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << '\n' << usage();
+            return EXIT_FAILURE;
+        }
+    }
+}
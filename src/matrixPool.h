@@ -0,0 +1,158 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <vector> // needed for the free lists
+#include <array> // needed for the size classes
+#include <mutex> // needed to guard the free lists
+#include <atomic> // needed for the counters
+#include <bit> // needed for std::bit_width
+#include <memory_resource> // needed for std::pmr::memory_resource
+
+#include "matrixAllocator.h" // `MATRIX_ALIGNMENT` and `MatrixResourceScope`
+
+/**
+ * A `std::pmr::memory_resource` that recycles matrix buffers by size class instead of going back to the heap for every one.
+ * Sizes are rounded up to one of four classes per power of two (so at most 25% is wasted) and a freed buffer goes on its
+ * class's free list, where the next request of that class picks it up. `release()` hands every free buffer back in one go.
+ * Buffers bigger than `MAX_CLASS` go straight to the upstream resource.
+ *
+ * Pass it to a matrix (`Matrix<int> m(n, n, &pool);`) or make it the default for a block of code with `MatrixResourceScope`.
+ * Each size class has its own lock; give every request (or thread) its own pool so the locks are never contended.
+ * For an arena that frees everything at once without recycling, a `std::pmr::monotonic_buffer_resource` works the same way.
+ * Every matrix taken from the pool must be gone before the pool is destroyed; `release()` (which the destructor calls) only
+ * frees the buffers on the free lists, so a matrix that outlives its pool would give its buffer back to a pool that no longer exists
+ */
+class MatrixPool : public std::pmr::memory_resource {
+public:
+    static constexpr size_t MIN_CLASS = MATRIX_ALIGNMENT; // the smallest buffer handed out
+    static constexpr size_t MAX_CLASS = size_t(1) << 30; // bigger buffers are not pooled (1 GiB)
+
+    // what the pool has done so far; see `stats()`
+    struct Stats {
+        size_t allocations = 0; // buffers handed out
+        size_t hits = 0; // of those, the ones that reused a free buffer
+        size_t bytesRequested = 0; // bytes asked for in total
+        size_t bytesInUse = 0; // bytes currently handed out (rounded up to the size class)
+        size_t bytesHeld = 0; // bytes currently taken from upstream, in use or on a free list
+        double hitRate() const { return allocations ? static_cast<double>(hits) / static_cast<double>(allocations) : 0.0; }
+    };
+
+    /**
+     * @brief Construct a new, empty MatrixPool
+     * @param _upstream where new buffers come from and freed ones go back to
+     */
+    explicit MatrixPool(std::pmr::memory_resource* _upstream = std::pmr::new_delete_resource()) : upstream(_upstream) {}
+
+    MatrixPool(const MatrixPool&) = delete; // buffers belong to exactly one pool
+    MatrixPool& operator=(const MatrixPool&) = delete;
+
+    ~MatrixPool() { release(); }
+
+    /**
+     * Gives every free buffer back to upstream; buffers still in use are not touched
+     */
+    void release() {
+        for (size_t c = 0; c < CLASSES; c++) {
+            std::lock_guard<std::mutex> lock(classes[c].mutex);
+            for (void* p : classes[c].free) upstream->deallocate(p, classSize(c), MATRIX_ALIGNMENT);
+            bytesHeld.fetch_sub(classes[c].free.size() * classSize(c), std::memory_order_relaxed);
+            classes[c].free.clear();
+            classes[c].free.shrink_to_fit();
+        }
+    }
+
+    /**
+     * Gets the counters; they are read one at a time, so while other threads use the pool they may not add up exactly
+     * @return Stats the counters
+     */
+    Stats stats() const {
+        Stats s;
+        s.allocations = allocations.load(std::memory_order_relaxed);
+        s.hits = hits.load(std::memory_order_relaxed);
+        s.bytesRequested = bytesRequested.load(std::memory_order_relaxed);
+        s.bytesInUse = bytesInUse.load(std::memory_order_relaxed);
+        s.bytesHeld = bytesHeld.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    /**
+     * Starts the allocation, hit and requested byte counts over (the in use and held bytes are left as they are)
+     */
+    void resetStats() {
+        allocations.store(0, std::memory_order_relaxed);
+        hits.store(0, std::memory_order_relaxed);
+        bytesRequested.store(0, std::memory_order_relaxed);
+    }
+
+    std::pmr::memory_resource* upstreamResource() const { return upstream; } // where buffers come from
+
+private:
+    // 64 B up to 1 GiB with four classes per power of two
+    static constexpr size_t CLASSES = (std::bit_width(MAX_CLASS) - std::bit_width(MIN_CLASS)) * 4 + 1;
+    static constexpr size_t NOT_POOLED = static_cast<size_t>(-1);
+
+    // the size of class `c`: (4 + c % 4) quarters of the power of two it is in
+    static constexpr size_t classSize(size_t c) { return (4 + c % 4) << (c / 4 + std::bit_width(MIN_CLASS) - 3); }
+
+    // the smallest class that fits `bytes`, or `NOT_POOLED`
+    static size_t classOf(size_t bytes, size_t alignment) {
+        if (bytes > MAX_CLASS || alignment > MATRIX_ALIGNMENT) return NOT_POOLED;
+        if (bytes <= MIN_CLASS) return 0;
+        const size_t top = std::bit_width(bytes - 1) - 1; // the power of two `bytes` is in (2^top < bytes <= 2^(top + 1))
+        const size_t quarter = size_t(1) << (top - 2);
+        const size_t quarters = (bytes + quarter - 1) / quarter; // 5 to 8
+        return (top - (std::bit_width(MIN_CLASS) - 1)) * 4 + (quarters - 4);
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytesRequested.fetch_add(bytes, std::memory_order_relaxed);
+        const size_t c = classOf(bytes, alignment);
+        if (c == NOT_POOLED) {
+            void* p = upstream->allocate(bytes, alignment);
+            bytesInUse.fetch_add(bytes, std::memory_order_relaxed);
+            bytesHeld.fetch_add(bytes, std::memory_order_relaxed);
+            return p;
+        }
+
+        const size_t size = classSize(c);
+        bytesInUse.fetch_add(size, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(classes[c].mutex);
+            if (!classes[c].free.empty()) {
+                void* p = classes[c].free.back();
+                classes[c].free.pop_back();
+                hits.fetch_add(1, std::memory_order_relaxed);
+                return p;
+            }
+        }
+        void* p = upstream->allocate(size, MATRIX_ALIGNMENT); // outside the lock; upstream may be slow
+        bytesHeld.fetch_add(size, std::memory_order_relaxed);
+        return p;
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        const size_t c = classOf(bytes, alignment);
+        if (c == NOT_POOLED) {
+            upstream->deallocate(p, bytes, alignment);
+            bytesInUse.fetch_sub(bytes, std::memory_order_relaxed);
+            bytesHeld.fetch_sub(bytes, std::memory_order_relaxed);
+            return;
+        }
+        bytesInUse.fetch_sub(classSize(c), std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(classes[c].mutex);
+        classes[c].free.push_back(p);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    // one size class; aligned so two classes' locks never share a cache line
+    struct alignas(MATRIX_ALIGNMENT) SizeClass {
+        std::mutex mutex; // guards `free`
+        std::vector<void*> free; // buffers of this class ready to be handed out again
+    };
+
+    std::pmr::memory_resource* upstream; // where buffers come from
+    std::array<SizeClass, CLASSES> classes;
+    std::atomic<size_t> allocations{0}, hits{0}, bytesRequested{0}, bytesInUse{0}, bytesHeld{0};
+};
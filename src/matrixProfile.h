@@ -0,0 +1,367 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <cstdint> // needed for `uint64_t`
+#include <cstdlib> // needed for std::atexit and std::getenv
+#include <array> // needed for the per-operation counters
+#include <vector> // needed for the thread list and the trace events
+#include <memory> // needed for std::shared_ptr
+#include <mutex> // needed to guard the thread list and the trace buffers
+#include <atomic> // needed for counters another thread can read
+#include <chrono> // needed for timing
+#include <bit> // needed for std::bit_width
+#include <ostream> // needed for the reports
+#include <fstream> // needed to write the reports to files
+#include <iostream> // needed for the summary at exit
+#include <cstdio> // needed for std::snprintf
+#include <algorithm> // needed for std::min, std::max and std::sort
+
+// build with `-DMATRIX_PROFILE=1` (`make PROFILE=1`) to record; without it every hook below compiles to nothing
+#ifndef MATRIX_PROFILE
+#define MATRIX_PROFILE 0
+#endif
+
+/**
+ * Opt-in instrumentation for the hot paths: parsing, elementwise arithmetic, multiply, transpose, diagonal sums and printing.
+ * Each of them opens a `MATRIX_PROFILE_SCOPE`, which records the call count, the latency (in a histogram of powers of two),
+ * roughly the bytes the operation touched and how many buffers it allocated (see `MATRIX_PROFILE_ALLOC` in matrixAllocator.h).
+ * Every thread counts into its own counters so the hooks never share a cache line; `snapshot()` adds them all up.
+ * Times are inclusive: a multiply inside `a * b + c` is counted under `multiply` and also inside the `elementwise` pass around it.
+ *
+ *     profile::setTracing(true); // also keep every call as a trace event
+ *     ...
+ *     profile::Snapshot s = profile::snapshot();
+ *     s.writeJson(std::cout);
+ *     std::ofstream trace("trace.json"); s.writeChromeTrace(trace); // open in chrome://tracing or ui.perfetto.dev
+ */
+namespace profile {
+
+    // true when the hooks are compiled in
+    inline constexpr bool enabled = MATRIX_PROFILE != 0;
+
+    /**
+     * The operations that are measured
+     */
+    enum class Op : unsigned { Parse, Elementwise, Multiply, Transpose, Diagonal, Print, Other, Count };
+    inline constexpr size_t OP_COUNT = static_cast<size_t>(Op::Count);
+    inline constexpr const char* opNames[OP_COUNT] = {"parse", "elementwise", "multiply", "transpose", "diagonal", "print", "other"};
+
+    // latency bucket b counts the calls that took [2^b, 2^(b+1)) ns (bucket 0 also holds 0 ns); the last bucket holds the rest
+    inline constexpr size_t BUCKETS = 40; // up to about 9 minutes
+
+    // each thread keeps at most this many trace events; later ones are counted in `Snapshot::droppedEvents`
+    inline size_t maxTraceEvents = size_t(1) << 20;
+
+    // nanoseconds since the first time the profiler asked for the time
+    inline uint64_t now() {
+        static const auto epoch = std::chrono::steady_clock::now();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    // one call of one operation, as kept for the Chrome trace
+    struct TraceEvent {
+        Op op;
+        size_t thread; // the index of the thread in the order threads first recorded something
+        uint64_t startNs, durationNs;
+        uint64_t bytes;
+    };
+
+    /**
+     * The counters of one operation; in a `Snapshot` they are the sum over every thread
+     */
+    struct OpStats {
+        uint64_t calls = 0;
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+        uint64_t bytes = 0; // bytes touched: operands and result for multiply and transpose, the result for elementwise, the text for parse and print
+        uint64_t allocations = 0; // buffers allocated while the operation was the innermost one running
+        uint64_t allocatedBytes = 0;
+        std::array<uint64_t, BUCKETS> histogram{};
+
+        /**
+         * An upper bound of the `p`-th percentile latency, from the histogram (so to within a factor of two)
+         * @param p the percentile, 0 to 100
+         * @return uint64_t nanoseconds
+         */
+        uint64_t percentileNs(double p) const {
+            if (calls == 0) return 0;
+            const double rank = p / 100.0 * static_cast<double>(calls);
+            uint64_t seen = 0;
+            for (size_t b = 0; b < BUCKETS; b++) {
+                seen += histogram[b];
+                if (static_cast<double>(seen) >= rank && seen > 0) return std::min(maxNs, uint64_t(1) << (b + 1));
+            }
+            return maxNs;
+        }
+    };
+
+    /**
+     * Everything recorded up to the moment `snapshot()` was called
+     */
+    struct Snapshot {
+        std::array<OpStats, OP_COUNT> ops{};
+        std::vector<TraceEvent> events; // only when tracing was on; sorted by start time
+        uint64_t droppedEvents = 0; // trace events that did not fit in `maxTraceEvents`
+        size_t threads = 0; // threads that recorded something
+
+        const OpStats& operator[](Op op) const { return ops[static_cast<size_t>(op)]; }
+
+        /**
+         * Writes the counters as one JSON object: `{"enabled": ..., "threads": ..., "ops": {"multiply": {...}, ...}}`.
+         * Each op has its counts, mean/p50/p99/max latency in ns and its nonzero histogram buckets as `[upper bound ns, count]`
+         */
+        void writeJson(std::ostream& os) const {
+            os << "{\"enabled\": " << (enabled ? "true" : "false") << ", \"threads\": " << threads
+               << ", \"droppedEvents\": " << droppedEvents << ", \"ops\": {";
+            for (size_t o = 0; o < OP_COUNT; o++) {
+                const OpStats& s = ops[o];
+                os << (o ? ", " : "") << '"' << opNames[o] << "\": {\"calls\": " << s.calls << ", \"totalNs\": " << s.totalNs
+                   << ", \"meanNs\": " << (s.calls ? s.totalNs / s.calls : 0) << ", \"p50Ns\": " << s.percentileNs(50)
+                   << ", \"p99Ns\": " << s.percentileNs(99) << ", \"maxNs\": " << s.maxNs << ", \"bytes\": " << s.bytes
+                   << ", \"allocations\": " << s.allocations << ", \"allocatedBytes\": " << s.allocatedBytes << ", \"histogram\": [";
+                bool first = true;
+                for (size_t b = 0; b < BUCKETS; b++) {
+                    if (!s.histogram[b]) continue;
+                    os << (first ? "" : ", ") << '[' << (uint64_t(1) << (b + 1)) << ", " << s.histogram[b] << ']';
+                    first = false;
+                }
+                os << "]}";
+            }
+            os << "}}\n";
+        }
+
+        /**
+         * Writes the trace events in the Chrome trace event format (complete "X" events, times in microseconds)
+         */
+        void writeChromeTrace(std::ostream& os) const {
+            os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+            char buffer[64];
+            for (size_t i = 0; i < events.size(); i++) {
+                const TraceEvent& e = events[i];
+                os << (i ? ",\n" : "\n") << "{\"name\": \"" << opNames[static_cast<size_t>(e.op)] << "\", \"cat\": \"matrix\", \"ph\": \"X\"";
+                std::snprintf(buffer, sizeof(buffer), ", \"ts\": %.3f, \"dur\": %.3f", e.startNs / 1e3, e.durationNs / 1e3);
+                os << buffer << ", \"pid\": 1, \"tid\": " << e.thread << ", \"args\": {\"bytes\": " << e.bytes << "}}";
+            }
+            os << "\n]}\n";
+        }
+
+        /**
+         * Prints a table with one line per operation that was called
+         */
+        void printSummary(std::ostream& os) const {
+            char line[256];
+            std::snprintf(line, sizeof(line), "%-12s %10s %12s %10s %10s %10s %10s %12s %8s\n",
+                          "op", "calls", "total ms", "mean us", "p50 us", "p99 us", "max us", "MB", "allocs");
+            os << line;
+            for (size_t o = 0; o < OP_COUNT; o++) {
+                const OpStats& s = ops[o];
+                if (!s.calls && !s.allocations) continue; // `other` has no calls, only the allocations made outside any operation
+                std::snprintf(line, sizeof(line), "%-12s %10llu %12.3f %10.3f %10.3f %10.3f %10.3f %12.3f %8llu\n",
+                              opNames[o], static_cast<unsigned long long>(s.calls), s.totalNs / 1e6,
+                              s.calls ? static_cast<double>(s.totalNs) / static_cast<double>(s.calls) / 1e3 : 0.0, // as `writeJson`
+                              s.percentileNs(50) / 1e3, s.percentileNs(99) / 1e3, s.maxNs / 1e3, s.bytes / 1e6,
+                              static_cast<unsigned long long>(s.allocations));
+                os << line;
+            }
+        }
+    };
+
+    namespace detail {
+        // only the owning thread writes a counter, so a plain load and store is enough (and cheaper than a locked add);
+        // they are atomics so `snapshot()` can read them from another thread
+        inline void bump(std::atomic<uint64_t>& counter, uint64_t by) {
+            counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+        }
+
+        struct OpCounters {
+            std::atomic<uint64_t> calls{0}, totalNs{0}, maxNs{0}, bytes{0}, allocations{0}, allocatedBytes{0};
+            std::array<std::atomic<uint64_t>, BUCKETS> histogram{};
+        };
+
+        // everything one thread records
+        struct ThreadState {
+            size_t index = 0;
+            std::array<OpCounters, OP_COUNT> ops;
+            Op current = Op::Other; // the innermost operation running on this thread; allocations are charged to it
+            std::mutex eventMutex; // guards `events`; only contended while a snapshot is being taken
+            std::vector<TraceEvent> events;
+            uint64_t dropped = 0;
+        };
+
+        // every thread that ever recorded something; kept after the thread ends so its counts are not lost
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadState>> threads;
+        };
+
+        inline Registry& registry() {
+            static Registry r;
+            return r;
+        }
+
+        inline std::atomic<bool>& tracing() {
+            static std::atomic<bool> on{false};
+            return on;
+        }
+
+        inline ThreadState& local() {
+            static thread_local std::shared_ptr<ThreadState> state = [] {
+                auto s = std::make_shared<ThreadState>();
+                Registry& r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                s->index = r.threads.size();
+                r.threads.push_back(s);
+                return s;
+            }();
+            return *state;
+        }
+    }
+
+    /**
+     * Turns keeping a trace event for every call on or off (off by default; the counters are always kept)
+     */
+    inline void setTracing(bool on) { detail::tracing().store(on, std::memory_order_relaxed); }
+
+    /**
+     * Charges an allocation to the operation running on this thread; called by `AlignedAllocator`
+     * @param bytes the size of the allocation
+     */
+    inline void countAllocation(size_t bytes) {
+        detail::ThreadState& t = detail::local();
+        detail::OpCounters& c = t.ops[static_cast<size_t>(t.current)];
+        detail::bump(c.allocations, 1);
+        detail::bump(c.allocatedBytes, bytes);
+    }
+
+    /**
+     * Measures one call of an operation from its construction to its destruction; use it through `MATRIX_PROFILE_SCOPE`
+     */
+    class Scope {
+    public:
+        Scope(Op _op, uint64_t _bytes) : state(detail::local()), op(_op), previous(state.current), bytes(_bytes), start(now()) {
+            state.current = op;
+        }
+
+        ~Scope() {
+            const uint64_t duration = now() - start;
+            detail::OpCounters& c = state.ops[static_cast<size_t>(op)];
+            detail::bump(c.calls, 1);
+            detail::bump(c.totalNs, duration);
+            detail::bump(c.bytes, bytes);
+            if (duration > c.maxNs.load(std::memory_order_relaxed)) c.maxNs.store(duration, std::memory_order_relaxed);
+            const size_t bucket = std::min<size_t>(duration ? std::bit_width(duration) - 1 : 0, BUCKETS - 1);
+            detail::bump(c.histogram[bucket], 1);
+            if (detail::tracing().load(std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> lock(state.eventMutex);
+                if (state.events.size() < maxTraceEvents) state.events.push_back(TraceEvent{op, state.index, start, duration, bytes});
+                else state.dropped++;
+            }
+            state.current = previous;
+        }
+
+        // adds to the bytes of this call once they are known (e.g. how much text was written)
+        void addBytes(uint64_t more) { bytes += more; }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        detail::ThreadState& state;
+        Op op, previous;
+        uint64_t bytes;
+        uint64_t start;
+    };
+
+    /**
+     * Adds up the counters of every thread. Threads still recording while this runs may be caught mid-update,
+     * so the totals can be off by the calls in flight
+     * @return Snapshot the totals, and the trace events if tracing was on
+     */
+    inline Snapshot snapshot() {
+        Snapshot s;
+        detail::Registry& r = detail::registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        s.threads = r.threads.size();
+        for (const auto& t : r.threads) {
+            for (size_t o = 0; o < OP_COUNT; o++) {
+                const detail::OpCounters& c = t->ops[o];
+                OpStats& out = s.ops[o];
+                out.calls += c.calls.load(std::memory_order_relaxed);
+                out.totalNs += c.totalNs.load(std::memory_order_relaxed);
+                out.maxNs = std::max(out.maxNs, c.maxNs.load(std::memory_order_relaxed));
+                out.bytes += c.bytes.load(std::memory_order_relaxed);
+                out.allocations += c.allocations.load(std::memory_order_relaxed);
+                out.allocatedBytes += c.allocatedBytes.load(std::memory_order_relaxed);
+                for (size_t b = 0; b < BUCKETS; b++) out.histogram[b] += c.histogram[b].load(std::memory_order_relaxed);
+            }
+            std::lock_guard<std::mutex> eventLock(t->eventMutex);
+            s.events.insert(s.events.end(), t->events.begin(), t->events.end());
+            s.droppedEvents += t->dropped;
+        }
+        std::sort(s.events.begin(), s.events.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.startNs < b.startNs; });
+        return s;
+    }
+
+    /**
+     * Clears every counter and trace event (of every thread)
+     */
+    inline void reset() {
+        detail::Registry& r = detail::registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const auto& t : r.threads) {
+            for (detail::OpCounters& c : t->ops) {
+                for (auto* counter : {&c.calls, &c.totalNs, &c.maxNs, &c.bytes, &c.allocations, &c.allocatedBytes}) counter->store(0);
+                for (auto& h : c.histogram) h.store(0);
+            }
+            std::lock_guard<std::mutex> eventLock(t->eventMutex);
+            t->events.clear();
+            t->dropped = 0;
+        }
+    }
+
+    /**
+     * When the hooks are compiled in, prints the summary table to stderr when the program exits (also through `std::exit`).
+     * If `MATRIX_PROFILE_JSON` is set the counters are also written to that file, and if `MATRIX_PROFILE_TRACE` is set
+     * tracing is turned on now and the Chrome trace is written to that file at exit
+     */
+    inline void reportAtExit() {
+        if constexpr (enabled) {
+            if (std::getenv("MATRIX_PROFILE_TRACE")) setTracing(true);
+            // make the statics the handler uses now, so they are destroyed after it runs rather than before
+            detail::local();
+            detail::tracing();
+            now();
+            std::atexit([] {
+                Snapshot s = snapshot();
+                std::cerr << "\nmatrix profile:\n";
+                s.printSummary(std::cerr);
+                if (const char* path = std::getenv("MATRIX_PROFILE_JSON")) {
+                    std::ofstream out(path);
+                    s.writeJson(out);
+                }
+                if (const char* path = std::getenv("MATRIX_PROFILE_TRACE")) {
+                    std::ofstream out(path);
+                    s.writeChromeTrace(out);
+                }
+            });
+        }
+    }
+}
+
+#define MATRIX_PROFILE_CONCAT_(a, b) a##b
+#define MATRIX_PROFILE_CONCAT(a, b) MATRIX_PROFILE_CONCAT_(a, b)
+
+#if MATRIX_PROFILE
+// measures the rest of the enclosing block as one call of `op` that touched `bytes` bytes
+#define MATRIX_PROFILE_SCOPE(op, bytes) ::profile::Scope MATRIX_PROFILE_CONCAT(matrixProfileScope_, __LINE__)(::profile::Op::op, (bytes))
+// same, with a name so more bytes can be added later with `name.addBytes(n)`
+#define MATRIX_PROFILE_NAMED_SCOPE(name, op, bytes) ::profile::Scope name(::profile::Op::op, (bytes))
+#define MATRIX_PROFILE_ADD_BYTES(name, bytes) name.addBytes(bytes)
+// charges an allocation of `bytes` to the operation running on this thread
+#define MATRIX_PROFILE_ALLOC(bytes) ::profile::countAllocation(bytes)
+#else
+#define MATRIX_PROFILE_SCOPE(op, bytes) ((void)0)
+#define MATRIX_PROFILE_NAMED_SCOPE(name, op, bytes) ((void)0)
+#define MATRIX_PROFILE_ADD_BYTES(name, bytes) ((void)0)
+#define MATRIX_PROFILE_ALLOC(bytes) ((void)0)
+#endif
@@ -0,0 +1,272 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <cstdint> // needed for `uintptr_t` and `INT32_MAX`
+#include <type_traits> // needed for std::is_same_v
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MATRIX_SIMD_X86 1 // we can build the AVX kernels and pick between them at runtime
+#include <immintrin.h> // the AVX2/AVX-512 intrinsics
+#else
+#define MATRIX_SIMD_X86 0 // some other platform; only the scalar kernels exist
+#endif
+
+/**
+ * Vectorized kernels for the elementwise operations and reductions of `Matrix<T>`.
+ * Every kernel has an AVX-512 and an AVX2 version for `int`, `float` and `double` which are picked at runtime
+ * by asking the CPU what it supports (CPUID), so the binary does not need `-mavx2` and still runs on older hosts.
+ * Any other type, platform or CPU uses the plain scalar loop
+ */
+namespace simd {
+
+    /**
+     * The instruction sets the kernels can run on, in increasing order
+     */
+    enum class Level { Scalar, AVX2, AVX512 };
+
+    /**
+     * Asks the CPU which instruction sets it supports
+     * @return Level the best level this host can run
+     */
+    inline Level detectLevel() {
+#if MATRIX_SIMD_X86
+        __builtin_cpu_init(); // needed before `__builtin_cpu_supports` when called during static init
+        if (__builtin_cpu_supports("avx512f")) return Level::AVX512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Level::AVX2;
+#endif
+        return Level::Scalar;
+    }
+
+    // the level the kernels currently dispatch to; starts as the best the host supports
+    inline Level& activeLevel() {
+        static Level level = detectLevel();
+        return level;
+    }
+
+    /**
+     * Gets the instruction set the kernels will use
+     * @return Level the active level
+     */
+    inline Level level() { return activeLevel(); }
+
+    /**
+     * Caps the instruction set the kernels use (e.g. to compare against the scalar fallback).
+     * Asking for more than the CPU supports gives the best it does support
+     * @param wanted the highest level to use
+     */
+    inline void setLevel(Level wanted) {
+        Level best = detectLevel();
+        activeLevel() = wanted < best ? wanted : best;
+    }
+
+    // stores bigger than this go straight to memory (non-temporal) so a huge result does not push everything else out of the cache
+    inline size_t streamThreshold = size_t(32) << 20; // 32 MiB
+
+    // true for the element types that have vector kernels
+    template<class T>
+    inline constexpr bool vectorized = std::is_same_v<T, int> || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+    /**
+     * The plain loops; used for every type without vector kernels and as the fallback on older CPUs
+     */
+    namespace scalar {
+        template<class T>
+        void add(const T* a, const T* b, T* out, size_t n) { for (size_t i = 0; i < n; i++) out[i] = a[i] + b[i]; }
+
+        template<class T>
+        void sub(const T* a, const T* b, T* out, size_t n) { for (size_t i = 0; i < n; i++) out[i] = a[i] - b[i]; }
+
+        template<class T>
+        void scale(const T* a, T s, T* out, size_t n) { for (size_t i = 0; i < n; i++) out[i] = a[i] * s; }
+
+        template<class T>
+        void axpy(T alpha, const T* x, const T* y, T* out, size_t n) { for (size_t i = 0; i < n; i++) out[i] = alpha * x[i] + y[i]; }
+
+        template<class T>
+        void multiplyAdd(const T* a, const T* b, const T* c, T* out, size_t n) { for (size_t i = 0; i < n; i++) out[i] = a[i] * b[i] + c[i]; }
+
+        template<class T>
+        T sum(const T* p, size_t n, size_t stride) {
+            T total{};
+            for (size_t i = 0; i < n; i++) total += p[i * stride];
+            return total;
+        }
+    }
+
+#if MATRIX_SIMD_X86
+    // the loops are the same for every instruction set, only the `Ops` they are built with change,
+    // so `matrixSimdLoops.inl` is included once per instruction set with the matching target enabled.
+    // The gathers use the masked form with an all-ones mask; the unmasked intrinsics read an uninitialized
+    // pass-through register which GCC 12 warns about
+    namespace avx2 {
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+        template<class T> struct Ops;
+
+        template<>
+        struct Ops<float> {
+            typedef __m256 V; typedef __m256i I; // value and gather-index registers
+            static constexpr size_t W = 8; // lanes per register
+            static V load(const float* p) { return _mm256_loadu_ps(p); }
+            static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+            static void stream(float* p, V v) { _mm256_stream_ps(p, v); }
+            static V set1(float s) { return _mm256_set1_ps(s); }
+            static V zero() { return _mm256_setzero_ps(); }
+            static V add(V a, V b) { return _mm256_add_ps(a, b); }
+            static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+            static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+            static V madd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+            static I index(const int* idx) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx)); }
+            static V gather(const float* p, I idx) { return _mm256_mask_i32gather_ps(zero(), p, idx, _mm256_castsi256_ps(_mm256_set1_epi32(-1)), sizeof(float)); }
+        };
+
+        template<>
+        struct Ops<double> {
+            typedef __m256d V; typedef __m128i I;
+            static constexpr size_t W = 4;
+            static V load(const double* p) { return _mm256_loadu_pd(p); }
+            static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+            static void stream(double* p, V v) { _mm256_stream_pd(p, v); }
+            static V set1(double s) { return _mm256_set1_pd(s); }
+            static V zero() { return _mm256_setzero_pd(); }
+            static V add(V a, V b) { return _mm256_add_pd(a, b); }
+            static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+            static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+            static V madd(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }
+            static I index(const int* idx) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx)); }
+            static V gather(const double* p, I idx) { return _mm256_mask_i32gather_pd(zero(), p, idx, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), sizeof(double)); }
+        };
+
+        template<>
+        struct Ops<int> {
+            typedef __m256i V; typedef __m256i I;
+            static constexpr size_t W = 8;
+            static V load(const int* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+            static void store(int* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+            static void stream(int* p, V v) { _mm256_stream_si256(reinterpret_cast<__m256i*>(p), v); }
+            static V set1(int s) { return _mm256_set1_epi32(s); }
+            static V zero() { return _mm256_setzero_si256(); }
+            static V add(V a, V b) { return _mm256_add_epi32(a, b); }
+            static V sub(V a, V b) { return _mm256_sub_epi32(a, b); }
+            static V mul(V a, V b) { return _mm256_mullo_epi32(a, b); }
+            static V madd(V a, V b, V c) { return _mm256_add_epi32(_mm256_mullo_epi32(a, b), c); } // no integer fma
+            static I index(const int* idx) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx)); }
+            static V gather(const int* p, I idx) { return _mm256_mask_i32gather_epi32(zero(), p, idx, _mm256_set1_epi32(-1), sizeof(int)); }
+        };
+
+#include "matrixSimdLoops.inl"
+#pragma GCC pop_options
+    }
+
+    namespace avx512 {
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+        template<class T> struct Ops;
+
+        template<>
+        struct Ops<float> {
+            typedef __m512 V; typedef __m512i I;
+            static constexpr size_t W = 16;
+            static V load(const float* p) { return _mm512_loadu_ps(p); }
+            static void store(float* p, V v) { _mm512_storeu_ps(p, v); }
+            static void stream(float* p, V v) { _mm512_stream_ps(p, v); }
+            static V set1(float s) { return _mm512_set1_ps(s); }
+            static V zero() { return _mm512_setzero_ps(); }
+            static V add(V a, V b) { return _mm512_add_ps(a, b); }
+            static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+            static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+            static V madd(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+            static I index(const int* idx) { return _mm512_loadu_si512(idx); }
+            static V gather(const float* p, I idx) { return _mm512_mask_i32gather_ps(zero(), 0xFFFF, idx, p, sizeof(float)); }
+        };
+
+        template<>
+        struct Ops<double> {
+            typedef __m512d V; typedef __m256i I;
+            static constexpr size_t W = 8;
+            static V load(const double* p) { return _mm512_loadu_pd(p); }
+            static void store(double* p, V v) { _mm512_storeu_pd(p, v); }
+            static void stream(double* p, V v) { _mm512_stream_pd(p, v); }
+            static V set1(double s) { return _mm512_set1_pd(s); }
+            static V zero() { return _mm512_setzero_pd(); }
+            static V add(V a, V b) { return _mm512_add_pd(a, b); }
+            static V sub(V a, V b) { return _mm512_sub_pd(a, b); }
+            static V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+            static V madd(V a, V b, V c) { return _mm512_fmadd_pd(a, b, c); }
+            static I index(const int* idx) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx)); }
+            static V gather(const double* p, I idx) { return _mm512_mask_i32gather_pd(zero(), 0xFF, idx, p, sizeof(double)); }
+        };
+
+        template<>
+        struct Ops<int> {
+            typedef __m512i V; typedef __m512i I;
+            static constexpr size_t W = 16;
+            static V load(const int* p) { return _mm512_loadu_si512(p); }
+            static void store(int* p, V v) { _mm512_storeu_si512(p, v); }
+            static void stream(int* p, V v) { _mm512_stream_si512(reinterpret_cast<__m512i*>(p), v); }
+            static V set1(int s) { return _mm512_set1_epi32(s); }
+            static V zero() { return _mm512_setzero_si512(); }
+            static V add(V a, V b) { return _mm512_add_epi32(a, b); }
+            static V sub(V a, V b) { return _mm512_sub_epi32(a, b); }
+            static V mul(V a, V b) { return _mm512_mullo_epi32(a, b); }
+            static V madd(V a, V b, V c) { return _mm512_add_epi32(_mm512_mullo_epi32(a, b), c); }
+            static I index(const int* idx) { return _mm512_loadu_si512(idx); }
+            static V gather(const int* p, I idx) { return _mm512_mask_i32gather_epi32(zero(), 0xFFFF, idx, p, sizeof(int)); }
+        };
+
+#include "matrixSimdLoops.inl"
+#pragma GCC pop_options
+    }
+
+// picks the best kernel for `T` on this CPU; `call` is the kernel name and the rest are its arguments
+#define MATRIX_SIMD_DISPATCH(T, call, ...)                                              \
+    do {                                                                                \
+        if constexpr (vectorized<T>) {                                                  \
+            if (level() == Level::AVX512) return avx512::call(__VA_ARGS__);             \
+            if (level() == Level::AVX2) return avx2::call(__VA_ARGS__);                 \
+        }                                                                               \
+        return scalar::call(__VA_ARGS__);                                               \
+    } while (0)
+#else
+#define MATRIX_SIMD_DISPATCH(T, call, ...) return scalar::call(__VA_ARGS__)
+#endif
+
+    /**
+     * out = a + b for `n` elements
+     */
+    template<class T>
+    void add(const T* a, const T* b, T* out, size_t n) { MATRIX_SIMD_DISPATCH(T, add, a, b, out, n); }
+
+    /**
+     * out = a - b for `n` elements
+     */
+    template<class T>
+    void sub(const T* a, const T* b, T* out, size_t n) { MATRIX_SIMD_DISPATCH(T, sub, a, b, out, n); }
+
+    /**
+     * out = a * s for `n` elements
+     */
+    template<class T>
+    void scale(const T* a, T s, T* out, size_t n) { MATRIX_SIMD_DISPATCH(T, scale, a, s, out, n); }
+
+    /**
+     * out = alpha * x + y for `n` elements; a fused multiply-add for the floating point types
+     */
+    template<class T>
+    void axpy(T alpha, const T* x, const T* y, T* out, size_t n) { MATRIX_SIMD_DISPATCH(T, axpy, alpha, x, y, out, n); }
+
+    /**
+     * out = a * b + c for `n` elements (every operand is a vector); a fused multiply-add for the floating point types
+     */
+    template<class T>
+    void multiplyAdd(const T* a, const T* b, const T* c, T* out, size_t n) { MATRIX_SIMD_DISPATCH(T, multiplyAdd, a, b, c, out, n); }
+
+    /**
+     * Sums `n` elements that are `stride` elements apart (a stride of `cols + 1` walks a diagonal)
+     * @return T the sum
+     */
+    template<class T>
+    T sum(const T* p, size_t n, size_t stride = 1) { MATRIX_SIMD_DISPATCH(T, sum, p, n, stride); }
+
+#undef MATRIX_SIMD_DISPATCH
+}
@@ -0,0 +1,87 @@
+// The vector loops shared by every instruction set in `matrixSimd.h`.
+// This file is included inside `simd::avx2` and `simd::avx512` (with the matching `#pragma GCC target` active)
+// and builds its loops on whatever `Ops<T>` that namespace defines, so it has no header guard on purpose
+
+        /**
+         * Runs `op` over `n` elements a register at a time, then finishes the leftovers with `tail` one element at a time.
+         * Big outputs that are aligned are written with streaming stores so they skip the cache
+         */
+        template<class T, class VecOp, class ScalarOp>
+        void elementwise(T* out, size_t n, VecOp op, ScalarOp tail) {
+            typedef Ops<T> O;
+            size_t i = 0;
+            const bool stream = n * sizeof(T) >= streamThreshold && reinterpret_cast<uintptr_t>(out) % (O::W * sizeof(T)) == 0;
+            if (stream) {
+                for (; i + O::W <= n; i += O::W) O::stream(out + i, op(i));
+                _mm_sfence(); // streaming stores are weakly ordered; make them visible before anyone reads `out`
+            } else {
+                for (; i + O::W <= n; i += O::W) O::store(out + i, op(i));
+            }
+            for (; i < n; i++) out[i] = tail(i);
+        }
+
+        template<class T>
+        void add(const T* a, const T* b, T* out, size_t n) {
+            typedef Ops<T> O;
+            elementwise(out, n, [&](size_t i) { return O::add(O::load(a + i), O::load(b + i)); },
+                                [&](size_t i) { return a[i] + b[i]; });
+        }
+
+        template<class T>
+        void sub(const T* a, const T* b, T* out, size_t n) {
+            typedef Ops<T> O;
+            elementwise(out, n, [&](size_t i) { return O::sub(O::load(a + i), O::load(b + i)); },
+                                [&](size_t i) { return a[i] - b[i]; });
+        }
+
+        template<class T>
+        void scale(const T* a, T s, T* out, size_t n) {
+            typedef Ops<T> O;
+            const typename O::V vs = O::set1(s);
+            elementwise(out, n, [&](size_t i) { return O::mul(O::load(a + i), vs); },
+                                [&](size_t i) { return a[i] * s; });
+        }
+
+        template<class T>
+        void axpy(T alpha, const T* x, const T* y, T* out, size_t n) {
+            typedef Ops<T> O;
+            const typename O::V va = O::set1(alpha);
+            elementwise(out, n, [&](size_t i) { return O::madd(va, O::load(x + i), O::load(y + i)); },
+                                [&](size_t i) { return alpha * x[i] + y[i]; });
+        }
+
+        template<class T>
+        void multiplyAdd(const T* a, const T* b, const T* c, T* out, size_t n) {
+            typedef Ops<T> O;
+            elementwise(out, n, [&](size_t i) { return O::madd(O::load(a + i), O::load(b + i), O::load(c + i)); },
+                                [&](size_t i) { return a[i] * b[i] + c[i]; });
+        }
+
+        template<class T>
+        T sum(const T* p, size_t n, size_t stride) {
+            typedef Ops<T> O;
+            typename O::V acc0 = O::zero(), acc1 = O::zero(); // two accumulators to hide the add latency
+            size_t i = 0;
+            if (stride == 1) { // contiguous; plain vector loads
+                for (; i + 2 * O::W <= n; i += 2 * O::W) {
+                    acc0 = O::add(acc0, O::load(p + i));
+                    acc1 = O::add(acc1, O::load(p + i + O::W));
+                }
+            } else if (stride <= static_cast<size_t>(INT32_MAX) / (2 * O::W)) { // the gather offsets have to fit in an `int`
+                alignas(64) int idx[2 * O::W];
+                for (size_t l = 0; l < 2 * O::W; l++) idx[l] = static_cast<int>(l * stride);
+                const typename O::I lo = O::index(idx), hi = O::index(idx + O::W);
+                for (; i + 2 * O::W <= n; i += 2 * O::W) {
+                    const T* base = p + i * stride;
+                    acc0 = O::add(acc0, O::gather(base, lo));
+                    acc1 = O::add(acc1, O::gather(base, hi));
+                }
+            }
+
+            alignas(64) T lanes[O::W];
+            O::store(lanes, O::add(acc0, acc1));
+            T total{};
+            for (size_t l = 0; l < O::W; l++) total += lanes[l]; // fold the lanes together
+            for (; i < n; i++) total += p[i * stride]; // and whatever did not fill a whole register
+            return total;
+        }
@@ -0,0 +1,149 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <vector> // needed for the scratch matrices
+#include <algorithm> // needed for std::copy and std::max
+
+#include "matrixAllocator.h" // aligned scratch buffers
+#include "matrixGemm.h" // the regular kernel the recursion bottoms out in
+#include "matrixSimd.h" // vectorized add/sub for the quadrant sums
+#include "threadPool.h" // splits the quadrant sums over threads
+
+/**
+ * Which algorithm multiplies two matrices; set per element type with `Matrix<T>::multiplyPolicy`
+ */
+enum class MultiplyPolicy {
+    Standard, // the blocked O(N^3) kernel (the default)
+    Strassen, // Strassen-Winograd for square matrices bigger than `StrassenConfig<T>::cutoff`; anything else uses `Standard`
+};
+
+/**
+ * Tuning for the Strassen-Winograd multiply; can be changed at runtime, e.g. `StrassenConfig<int>::cutoff = 1024;`.
+ * Below the cutoff the blocked kernel is faster than paying for another level of quadrant sums.
+ * `bench/strassen.cpp` sweeps N to find where the crossover is on a given machine
+ * @tparam T the element type
+ */
+template<class T>
+struct StrassenConfig {
+    static inline size_t cutoff = 256; // sub-problems this size or smaller go to the blocked kernel
+};
+
+/**
+ * Namespace for the Strassen-Winograd multiply; the entry point is `strassen::multiply`.
+ *
+ * Each level splits A, B and C into quadrants and forms the product from 7 half-size multiplies and 15 quadrant
+ * additions (Winograd's variant of Strassen) instead of 8 multiplies, so the work drops from O(N^3) to O(N^2.81).
+ * Only `+`, `-` and `*` are used (no division, no rounding), so for integer types the result is exactly what the blocked
+ * kernel gives as long as nothing overflows; for floating point types the error is larger than with the blocked kernel.
+ * Odd sizes are handled by peeling: the even (N-1)x(N-1) part recurses and the last row and col are fixed up with the
+ * blocked kernel
+ */
+namespace strassen {
+
+    template<class T>
+    using buffer_t = std::vector<T, AlignedAllocator<T>>;
+
+    // out = a + b over `n` x `n` blocks with their own leading dimensions
+    template<class T>
+    void add(const T* a, size_t lda, const T* b, size_t ldb, T* out, size_t ldo, size_t n) {
+        parallelFor(0, n, std::max<size_t>(1, ThreadPool::minParallelElements / std::max<size_t>(n, 1)), [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; i++) simd::add(a + i * lda, b + i * ldb, out + i * ldo, n);
+        });
+    }
+
+    // out = a - b over `n` x `n` blocks with their own leading dimensions
+    template<class T>
+    void sub(const T* a, size_t lda, const T* b, size_t ldb, T* out, size_t ldo, size_t n) {
+        parallelFor(0, n, std::max<size_t>(1, ThreadPool::minParallelElements / std::max<size_t>(n, 1)), [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; i++) simd::sub(a + i * lda, b + i * ldb, out + i * ldo, n);
+        });
+    }
+
+    // out = a over `n` x `n` blocks
+    template<class T>
+    void copy(const T* a, size_t lda, T* out, size_t ldo, size_t n) {
+        for (size_t i = 0; i < n; i++) std::copy(a + i * lda, a + i * lda + n, out + i * ldo);
+    }
+
+    /**
+     * C = A * B for `n` x `n` row-major blocks; C must not overlap A or B
+     */
+    template<class T>
+    void recurse(const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc, size_t n, size_t cutoff) {
+        if (n <= cutoff || n < 2) { // small enough that the blocked kernel wins
+            gemm::multiply(A, lda, B, ldb, C, ldc, n, n, n);
+            return;
+        }
+
+        if (n % 2) { // odd: recurse on the even top-left block and fix up the last row and col with the blocked kernel
+            const size_t m = n - 1;
+            recurse(A, lda, B, ldb, C, ldc, m, cutoff); // C11 = A11 * B11
+            gemm::multiply(A + m, lda, B + m * ldb, ldb, C, ldc, m, m, 1, true); // C11 += a12 * b21 (a rank 1 update)
+            gemm::multiply(A, lda, B + m, ldb, C + m, ldc, m, 1, n); // last col: C[0:m, m] = A[0:m, :] * B[:, m]
+            gemm::multiply(A + m * lda, lda, B, ldb, C + m * ldc, ldc, 1, n, n); // last row: C[m, :] = A[m, :] * B
+            return;
+        }
+
+        const size_t h = n / 2;
+        const T *A11 = A, *A12 = A + h, *A21 = A + h * lda, *A22 = A + h * lda + h;
+        const T *B11 = B, *B12 = B + h, *B21 = B + h * ldb, *B22 = B + h * ldb + h;
+        T *C11 = C, *C12 = C + h, *C21 = C + h * ldc, *C22 = C + h * ldc + h;
+
+        // three scratch quadrants; the C quadrants hold the other partial products so nothing else is needed
+        buffer_t<T> scratch(3 * h * h);
+        T *X = scratch.data(), *Y = X + h * h, *Z = Y + h * h;
+
+        // the schedule below gives (with S/T the sums of A/B quadrants and P1..P7 the products)
+        //   C11 = P1 + P2,  C12 = P1 + P6 + P5 + P3,  C21 = P1 + P6 + P7 - P4,  C22 = P1 + P6 + P7 + P5
+        recurse(A11, lda, B11, ldb, Z, h, h, cutoff); // Z = P1 = A11 * B11
+        recurse(A12, lda, B21, ldb, C11, ldc, h, cutoff); // C11 = P2 = A12 * B21
+        add(C11, ldc, Z, h, C11, ldc, h); // C11 = P1 + P2 (done)
+
+        add(A21, lda, A22, lda, X, h, h); // X = S1 = A21 + A22
+        sub(B12, ldb, B11, ldb, Y, h, h); // Y = T1 = B12 - B11
+        recurse(X, h, Y, h, C22, ldc, h, cutoff); // C22 = P5 = S1 * T1
+
+        sub(X, h, A11, lda, X, h, h); // X = S2 = S1 - A11
+        sub(B22, ldb, Y, h, Y, h, h); // Y = T2 = B22 - T1
+        recurse(X, h, Y, h, C12, ldc, h, cutoff); // C12 = P6 = S2 * T2
+        add(C12, ldc, Z, h, C12, ldc, h); // C12 = U2 = P1 + P6
+
+        sub(A12, lda, X, h, X, h, h); // X = S4 = A12 - S2
+        recurse(X, h, B22, ldb, Z, h, h, cutoff); // Z = P3 = S4 * B22
+
+        sub(Y, h, B21, ldb, Y, h, h); // Y = T4 = T2 - B21
+        recurse(A22, lda, Y, h, C21, ldc, h, cutoff); // C21 = P4 = A22 * T4
+        sub(C12, ldc, C21, ldc, C21, ldc, h); // C21 = U2 - P4
+
+        add(C12, ldc, C22, ldc, C12, ldc, h); // C12 = U4 = U2 + P5
+        copy(C12, ldc, C22, ldc, h); // C22 = U4
+        add(C12, ldc, Z, h, C12, ldc, h); // C12 = U4 + P3 (done)
+
+        sub(A11, lda, A21, lda, X, h, h); // X = S3 = A11 - A21
+        sub(B22, ldb, B12, ldb, Y, h, h); // Y = T3 = B22 - B12
+        recurse(X, h, Y, h, Z, h, h, cutoff); // Z = P7 = S3 * T3
+        add(C21, ldc, Z, h, C21, ldc, h); // C21 = U2 - P4 + P7 (done)
+        add(C22, ldc, Z, h, C22, ldc, h); // C22 = U4 + P7 (done)
+    }
+
+    /**
+     * Strassen-Winograd multiply of raw row-major buffers: C (+)= A * B, all `n` x `n`
+     * @param A pointer to the left matrix with leading dimension `lda`
+     * @param B pointer to the right matrix with leading dimension `ldb`
+     * @param C pointer to the result with leading dimension `ldc`; must not overlap A or B
+     * @param n the size of all three matrices
+     * @param accumulate add the product to what is already in C instead of overwriting it
+     */
+    template<class T>
+    void multiply(const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc, size_t n, bool accumulate = false) {
+        const size_t cutoff = StrassenConfig<T>::cutoff;
+        if (!accumulate) {
+            recurse(A, lda, B, ldb, C, ldc, n, cutoff);
+            return;
+        }
+        // the recursion overwrites its output, so the product goes into a scratch matrix and is then added on
+        buffer_t<T> product(n * n);
+        recurse(A, lda, B, ldb, product.data(), n, n, cutoff);
+        add(C, ldc, product.data(), n, C, ldc, n);
+    }
+}
@@ -0,0 +1,388 @@
+#pragma once // header guard
+
+#include "matrix.h" // matrix class definition
+#include "sparseMatrix.h" // so a file can be read straight into CSR form
+#include "matrixBatched.h" // so a file can be read straight into a batch
+#include "matrixParser.h" // buffered line reading and `from_chars` parsing
+
+#include <cstddef> // needed for `size_t`
+#include <fstream> // needed to read files
+#include <string> // needed for std::string
+#include <vector> // needed for the batch pools
+#include <stdexcept> // needed for exceptions
+#include <iterator> // needed for the iterator tags
+#include <thread> // needed for the prefetch thread
+#include <mutex> // needed to hand batches between threads
+#include <condition_variable> // needed to wait for a batch
+#include <exception> // needed to carry errors from the prefetch thread
+#include <utility> // needed for std::exchange
+#include <algorithm> // needed for std::min
+
+/**
+ * Thrown when a matrix file cannot be read. `what()` is the same message `MatrixReader` prints;
+ * `line()` and `matrix()` say where in the file it went wrong
+ */
+class MatrixReadError : public std::runtime_error {
+public:
+    /**
+     * @brief Construct a new MatrixReadError
+     * @param message what went wrong
+     * @param _line the line of the file (1 based; 0 if not tied to a line)
+     * @param _matrix which matrix was being read (0 based)
+     */
+    MatrixReadError(const std::string& message, size_t _line = 0, size_t _matrix = 0)
+      : std::runtime_error(message), lineNumber(_line), matrixIndex(_matrix) {}
+
+    size_t line() const { return lineNumber; } // the line of the file (1 based; 0 if not tied to a line)
+    size_t matrix() const { return matrixIndex; } // which matrix was being read (0 based)
+
+private:
+    size_t lineNumber;
+    size_t matrixIndex;
+};
+
+/**
+ * Reads the matrices of a file one after another without ever exiting the process: errors are thrown as `MatrixReadError`.
+ * The file format is the one in `matrices.txt`: a size line `N` followed by any number of NxN matrices.
+ *
+ * It can be used three ways:
+ *   - `next(m)` fills an existing matrix (no allocation once `m` is NxN); `m` can also be a `SparseMatrix<T>`
+ *   - `readBatch(pool)` fills a whole preallocated pool at once, or appends to a `BatchedMatrices<T>`
+ *   - as a range: `for (const Matrix<T>& m : stream)`
+ * @tparam T Type of the matrix elements
+ */
+template<typename T>
+class MatrixStream {
+public:
+    MatrixStream() : lines(file) {}
+
+    /**
+     * @brief Opens `filename` and reads the size line
+     * @param filename path to the file containing matrix data
+     */
+    explicit MatrixStream(const std::string& filename) : MatrixStream() { open(filename); }
+
+    // `lines` points at `file`, so a copied or moved stream would read from the wrong file
+    MatrixStream(const MatrixStream&) = delete;
+    MatrixStream& operator=(const MatrixStream&) = delete;
+
+    /**
+     * Opens `filename` and reads the size line; the stream must not already be open
+     * @param filename path to the file containing matrix data
+     */
+    void open(const std::string& filename) {
+        file.open(filename, std::ios::binary);
+        if (!file.is_open()) throw MatrixReadError("Could not open file: " + filename);
+
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        lines.nextLine(begin, end); // the first line holds the N of the NxN matrices
+        lineNumber = 1;
+        try {
+            N = std::stoul(std::string(begin, end)); // (an empty file gives an empty line so `stoul` reports it)
+        } catch (const std::exception& e) {
+            throw MatrixReadError(e.what(), lineNumber);
+        }
+    }
+
+    size_t size() const { return N; } // the N of the NxN matrices in the file
+    size_t count() const { return matrixCount; } // how many matrices have been read so far
+
+    /**
+     * Reads the next matrix into `out`, resizing it to NxN (which only allocates if it has never been that big)
+     * @param out where the matrix goes
+     * @return true if a matrix was read, false if the file ended cleanly before it
+     */
+    bool next(Matrix<T>& out) {
+        if (N == 0) return false; // a file of 0x0 matrices holds nothing to read
+        MATRIX_PROFILE_NAMED_SCOPE(profileScope, Parse, 0); // the bytes are the text parsed, added line by line
+        const char* begin = nullptr; // the current line; points straight into the scanner's buffer
+        const char* end = nullptr;
+        for (size_t i = 0; i < N; i++) {
+            if (!lines.nextLine(begin, end)) {
+                if (i == 0) return false; // no more matrices
+                // we expect at least enough data to fill an NxN matrix so a matrix cut short is an error
+                throw MatrixReadError("Unexpected end of file while reading matrix data.", lineNumber + 1, matrixCount);
+            }
+            lineNumber++;
+            MATRIX_PROFILE_ADD_BYTES(profileScope, static_cast<size_t>(end - begin) + 1);
+            if (i == 0) out.resize(N, N);
+
+            // parse the `N` values of the line straight into row `i` of the matrix (anything after them is ignored)
+            if (!parse::row(begin, end, out.ptr() + i * N, N))
+                throw MatrixReadError("Invalid matrix data format.", lineNumber, matrixCount);
+        }
+        matrixCount++;
+        return true;
+    }
+
+    /**
+     * Reads the next matrix straight into CSR form; each line is parsed into a one row buffer and only its nonzeros are kept,
+     * so the dense NxN matrix is never built
+     * @param out where the matrix goes; emptied and rebuilt (its buffers are reused)
+     * @return true if a matrix was read, false if the file ended cleanly before it
+     */
+    bool next(SparseMatrix<T>& out) {
+        if (N == 0) return false; // a file of 0x0 matrices holds nothing to read
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        for (size_t i = 0; i < N; i++) {
+            if (!lines.nextLine(begin, end)) {
+                if (i == 0) return false; // no more matrices
+                throw MatrixReadError("Unexpected end of file while reading matrix data.", lineNumber + 1, matrixCount);
+            }
+            lineNumber++;
+            if (i == 0) {
+                out.reset(N, N);
+                row.resize(N);
+            }
+
+            if (!parse::row(begin, end, row.data(), N))
+                throw MatrixReadError("Invalid matrix data format.", lineNumber, matrixCount);
+            out.appendRow(row.data(), N);
+        }
+        matrixCount++;
+        return true;
+    }
+
+    /**
+     * Fills the matrices of `pool` in order until the pool is full or the file ends
+     * @param pool the matrices to fill; their buffers are reused so a pool of NxN matrices is filled without allocating
+     * @return size_t how many were filled; less than `pool.size()` only when the file ended
+     */
+    size_t readBatch(std::vector<Matrix<T>>& pool) {
+        size_t filled = 0;
+        while (filled < pool.size() && next(pool[filled])) filled++;
+        return filled;
+    }
+
+    /**
+     * Appends the matrices of the file to `batch` until `limit` of them have been read or the file ends.
+     * Each line is parsed into a one row buffer and scattered into the batch's lane arrays
+     * @param batch the batch to append to; must be NxN or empty (an empty batch of another shape is reshaped to NxN)
+     * @param limit the most matrices to read
+     * @return size_t how many were appended; less than `limit` only when the file ended
+     */
+    size_t readBatch(BatchedMatrices<T>& batch, size_t limit = static_cast<size_t>(-1)) {
+        if (batch.numRows() != N || batch.numCols() != N) {
+            if (!batch.empty()) throw MatrixReadError("Batch holds matrices of a different size than the file.", lineNumber, matrixCount);
+            batch = BatchedMatrices<T>(N, N);
+        }
+        if (N == 0) return 0; // a file of 0x0 matrices holds nothing to read
+        batch.reserve(batch.size() + std::min<size_t>(limit, 1024));
+        row.resize(N);
+
+        size_t appended = 0;
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        while (appended < limit) {
+            const size_t m = batch.size();
+            for (size_t i = 0; i < N; i++) {
+                if (!lines.nextLine(begin, end)) {
+                    if (i == 0) return appended; // no more matrices
+                    batch.resize(m); // drop the half read matrix
+                    throw MatrixReadError("Unexpected end of file while reading matrix data.", lineNumber + 1, matrixCount);
+                }
+                lineNumber++;
+                if (i == 0) batch.resize(m + 1);
+
+                if (!parse::row(begin, end, row.data(), N)) {
+                    batch.resize(m);
+                    throw MatrixReadError("Invalid matrix data format.", lineNumber, matrixCount);
+                }
+                for (size_t j = 0; j < N; j++) batch(m, i, j) = row[j];
+            }
+            matrixCount++;
+            appended++;
+        }
+        return appended;
+    }
+
+    /**
+     * An input iterator over the rest of the file. Every step reads the next matrix into one buffer owned by the stream,
+     * so the matrix it points at is overwritten by the next `++` (copy it to keep it)
+     */
+    class iterator {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef Matrix<T> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Matrix<T>* pointer;
+        typedef const Matrix<T>& reference;
+
+        iterator() = default; // the end iterator
+        explicit iterator(MatrixStream* _stream) : stream(_stream) { ++*this; }
+
+        reference operator*() const { return stream->current; }
+        pointer operator->() const { return &stream->current; }
+
+        iterator& operator++() {
+            if (!stream->next(stream->current)) stream = nullptr; // the end of the file; become the end iterator
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        bool operator==(const iterator& other) const { return stream == other.stream; }
+        bool operator!=(const iterator& other) const { return stream != other.stream; }
+
+    private:
+        MatrixStream* stream = nullptr; // null once the file has ended
+    };
+
+    iterator begin() { return iterator(this); } // starts reading from wherever the stream is now
+    iterator end() { return iterator(); }
+
+private:
+    std::ifstream file; // the file which holds the matrices
+    LineScanner lines; // reads `file` a big chunk at a time and hands out one line at a time
+    size_t N = 0; // the size of the matrices
+    size_t lineNumber = 0; // the last line read (1 based)
+    size_t matrixCount = 0; // matrices read so far
+    Matrix<T> current{0, 0}; // the matrix the iterator points at
+    std::vector<T> row; // one parsed line when reading into a `SparseMatrix` or `BatchedMatrices`
+};
+
+/**
+ * A group of matrices handed out by `BatchReader::next()`; only valid until the following `next()` call
+ * @tparam T Type of the matrix elements
+ */
+template<typename T>
+class MatrixBatch {
+public:
+    MatrixBatch() = default;
+    MatrixBatch(Matrix<T>* _data, size_t _count) : ptr(_data), count(_count) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    explicit operator bool() const { return count > 0; } // false once the file is done
+
+    Matrix<T>& operator[](size_t i) const { return ptr[i]; }
+    Matrix<T>* begin() const { return ptr; }
+    Matrix<T>* end() const { return ptr + count; }
+
+private:
+    Matrix<T>* ptr = nullptr;
+    size_t count = 0;
+};
+
+/**
+ * Reads a matrix file in batches on a background thread so parsing the next batch overlaps with whatever the caller
+ * does with the current one. Two pools of up to `batchSize` matrices are swapped back and forth; each grows one matrix at a
+ * time as the file is parsed, so a pool never holds more matrices than have been read into it, and once both are full the
+ * steady state reuses their buffers and does not allocate at all.
+ *
+ *     BatchReader<int> reader("big.txt", 256);
+ *     while (auto batch = reader.next())
+ *         for (Matrix<int>& m : batch) total += m.trace();
+ *
+ * A read error is thrown from `next()` after every matrix before it has been handed out
+ * @tparam T Type of the matrix elements
+ */
+template<typename T>
+class BatchReader {
+public:
+    /**
+     * @brief Opens `filename` and starts parsing the first batch in the background
+     * @param filename path to the file containing matrix data
+     * @param batchSize how many matrices each batch holds
+     */
+    BatchReader(const std::string& filename, size_t batchSize) : stream(filename) {
+        if (batchSize == 0) throw std::invalid_argument("Batch size must be at least 1.");
+        limit = batchSize;
+        worker = std::thread(&BatchReader::prefetch, this);
+    }
+
+    BatchReader(const BatchReader&) = delete; // the thread points back at the reader
+    BatchReader& operator=(const BatchReader&) = delete;
+
+    ~BatchReader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        changed.notify_all();
+        worker.join();
+    }
+
+    size_t size() const { return stream.size(); } // the N of the NxN matrices in the file
+
+    /**
+     * Gives back the next batch and lets the background thread start refilling the previous one
+     * @return MatrixBatch<T> the matrices; empty once the file is done
+     */
+    MatrixBatch<T> next() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (inUse >= 0) { // the caller is done with the last batch; hand its pool back
+            pools[inUse].ready = false;
+            inUse = -1;
+            changed.notify_all();
+        }
+
+        // the pools are filled and handed out in the same order, so the next one is either coming or the file is done
+        Pool& pool = pools[consumeNext];
+        changed.wait(lock, [&] { return pool.ready || finished; });
+        if (!pool.ready) { // nothing more; report the error (once) if that is why it stopped
+            if (error) std::rethrow_exception(std::exchange(error, nullptr));
+            return MatrixBatch<T>();
+        }
+        inUse = consumeNext;
+        consumeNext ^= 1;
+        return MatrixBatch<T>(pool.matrices.data(), pool.count);
+    }
+
+private:
+    // one of the two sets of matrices; the background thread fills it, then the caller reads it
+    struct Pool {
+        std::vector<Matrix<T>> matrices;
+        size_t count = 0; // how many of `matrices` hold data
+        bool ready = false; // filled and waiting for (or in use by) the caller
+    };
+
+    // the background thread: fills the pools in turn until the file ends or fails
+    void prefetch() {
+        for (int fill = 0; ; fill ^= 1) {
+            Pool& pool = pools[fill];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return stopping || !pool.ready; });
+                if (stopping) return;
+            }
+
+            // parse without the lock so the caller can keep working on the other pool
+            size_t count = 0;
+            std::exception_ptr failure;
+            try {
+                while (count < limit) {
+                    if (count == pool.matrices.size()) pool.matrices.emplace_back(0, 0); // `next` sizes it; later batches reuse it
+                    if (!stream.next(pool.matrices[count])) break;
+                    count++;
+                }
+            } catch (...) { // the matrices before the bad one are still handed out; the error comes after them
+                failure = std::current_exception();
+            }
+
+            const bool done = failure || count < limit;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pool.count = count;
+                pool.ready = count > 0;
+                finished = done;
+                error = failure;
+            }
+            changed.notify_all();
+            if (done) return;
+        }
+    }
+
+    MatrixStream<T> stream; // only touched by `worker` once it has started
+    Pool pools[2];
+    size_t limit = 0; // the most matrices in one batch
+    std::thread worker; // parses batches in the background
+    int consumeNext = 0; // the pool the caller gets next
+    int inUse = -1; // the pool the caller holds, or -1
+    bool finished = false; // the background thread has read everything it will
+    bool stopping = false; // set by the destructor
+    std::exception_ptr error; // why the background thread stopped early, if it did
+    std::mutex mutex; // guards everything the two threads share except `stream` and the matrices
+    std::condition_variable changed; // signalled whenever a pool changes hands
+};
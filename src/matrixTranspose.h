@@ -0,0 +1,98 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <algorithm> // needed for std::max and std::swap
+
+#include "threadPool.h" // splits big transposes over threads
+
+/**
+ * Cache-oblivious transpose kernels on raw row-major buffers; `Matrix<T>::transposeInPlace`, `transpose` and `transposeInto`
+ * are built on these, and `a.transposed()` gives a view that needs no copy at all.
+ * A naive transpose reads rows and writes columns, so every write lands on a different cache line once the matrix is bigger
+ * than the cache. These split the longer side in half until a block fits in the L1 cache and only then copy, so every level of
+ * the cache hierarchy is used well without knowing its size
+ */
+namespace transposition {
+
+    // blocks with both sides at most this long are copied with the plain loop (32x32 doubles is 8 KiB per side)
+    inline size_t blockSize = 32;
+
+    /**
+     * dst = src^T for a `rows` x `cols` block of `src`, serially
+     * @param src the top left of the source block with leading dimension `lds`
+     * @param dst the top left of the `cols` x `rows` destination block with leading dimension `ldd`; must not overlap `src`
+     */
+    template<class T>
+    void copyBlock(const T* src, size_t lds, T* dst, size_t ldd, size_t rows, size_t cols) {
+        if (rows <= blockSize && cols <= blockSize) {
+            for (size_t i = 0; i < rows; i++)
+                for (size_t j = 0; j < cols; j++) dst[j * ldd + i] = src[i * lds + j];
+            return;
+        }
+        if (rows >= cols) { // split the longer side so the halves stay close to square
+            const size_t h = rows / 2;
+            copyBlock(src, lds, dst, ldd, h, cols);
+            copyBlock(src + h * lds, lds, dst + h, ldd, rows - h, cols);
+        } else {
+            const size_t h = cols / 2;
+            copyBlock(src, lds, dst, ldd, rows, h);
+            copyBlock(src + h, lds, dst + h * ldd, ldd, rows, cols - h);
+        }
+    }
+
+    /**
+     * dst = src^T for a `rows` x `cols` block of `src`; bands of source rows are split over the thread pool
+     * @param src the top left of the source block with leading dimension `lds`
+     * @param dst the top left of the `cols` x `rows` destination block with leading dimension `ldd`; must not overlap `src`
+     */
+    template<class T>
+    void copy(const T* src, size_t lds, T* dst, size_t ldd, size_t rows, size_t cols) {
+        // a band of source rows is a band of destination cols; whole blocks per band so two threads never write the same cache line
+        const size_t perBand = std::max<size_t>(1, ThreadPool::minParallelElements / std::max<size_t>(cols, 1));
+        const size_t grain = (perBand + blockSize - 1) / blockSize * blockSize;
+        parallelFor(0, rows, grain, [&](size_t lo, size_t hi) {
+            copyBlock(src + lo * lds, lds, dst + lo, ldd, hi - lo, cols);
+        });
+    }
+
+    /**
+     * Swaps a `rows` x `cols` block `a` with the transpose of the `cols` x `rows` block `b` (a[i][j] <-> b[j][i])
+     * @param a the top left of the first block with leading dimension `ld`
+     * @param b the top left of the second block with leading dimension `ld`; must not overlap `a`
+     */
+    template<class T>
+    void swapBlocks(T* a, T* b, size_t ld, size_t rows, size_t cols) {
+        if (rows <= blockSize && cols <= blockSize) {
+            for (size_t i = 0; i < rows; i++)
+                for (size_t j = 0; j < cols; j++) std::swap(a[i * ld + j], b[j * ld + i]);
+            return;
+        }
+        if (rows >= cols) {
+            const size_t h = rows / 2;
+            swapBlocks(a, b, ld, h, cols);
+            swapBlocks(a + h * ld, b + h, ld, rows - h, cols);
+        } else {
+            const size_t h = cols / 2;
+            swapBlocks(a, b, ld, rows, h);
+            swapBlocks(a + h, b + h * ld, ld, rows, cols - h);
+        }
+    }
+
+    /**
+     * Transposes an `n` x `n` block in place: the two diagonal quarters transpose themselves and the two off diagonal
+     * quarters swap with each other's transpose
+     * @param a the top left of the block with leading dimension `ld`
+     */
+    template<class T>
+    void square(T* a, size_t ld, size_t n) {
+        if (n <= blockSize) {
+            for (size_t i = 0; i < n; i++)
+                for (size_t j = i + 1; j < n; j++) std::swap(a[i * ld + j], a[j * ld + i]);
+            return;
+        }
+        const size_t h = n / 2;
+        swapBlocks(a + h, a + h * ld, ld, h, n - h); // top right with bottom left
+        square(a, ld, h);
+        square(a + h * ld + h, ld, n - h);
+    }
+}
@@ -0,0 +1,370 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <iterator> // needed for the iterator tags
+#include <algorithm> // needed for std::swap_ranges and std::min
+#include <stdexcept> // needed for throwing errors
+#include <type_traits> // needed for std::is_const and friends
+#include <mutex> // needed to combine the per-thread partial sums
+#include <functional> // needed for std::less on unrelated pointers
+
+#include "matrixSimd.h" // vectorized sums for the diagonals
+#include "threadPool.h" // splits very long diagonals over threads
+#include "matrixProfile.h" // opt-in timing of the diagonal sums
+
+/**
+ * A non-owning view over `size` elements that are `stride` elements apart in memory.
+ * A row of a row-major matrix has a stride of 1, a column has a stride of the row length
+ * and a diagonal has a stride of the row length + 1. Views never copy the data they point to
+ * @tparam T the element type; use `const T` for a read-only view
+ */
+template<class T>
+class StridedSpan {
+public:
+    /**
+     * Simple random access iterator that steps `stride` elements at a time
+     * so a `StridedSpan` can be used in range-for loops and with the standard algorithms
+     */
+    class iterator {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef std::remove_const_t<T> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T* pointer;
+        typedef T& reference;
+
+        iterator() = default;
+        iterator(T* _ptr, size_t _stride) : ptr(_ptr), stride(_stride) {}
+
+        reference operator*() const { return *ptr; }
+        pointer operator->() const { return ptr; }
+        reference operator[](difference_type n) const { return ptr[n * static_cast<difference_type>(stride)]; }
+
+        iterator& operator++() { ptr += stride; return *this; }
+        iterator operator++(int) { iterator tmp = *this; ptr += stride; return tmp; }
+        iterator& operator--() { ptr -= stride; return *this; }
+        iterator operator--(int) { iterator tmp = *this; ptr -= stride; return tmp; }
+        iterator& operator+=(difference_type n) { ptr += n * static_cast<difference_type>(stride); return *this; }
+        iterator& operator-=(difference_type n) { ptr -= n * static_cast<difference_type>(stride); return *this; }
+        friend iterator operator+(iterator it, difference_type n) { return it += n; }
+        friend iterator operator+(difference_type n, iterator it) { return it += n; }
+        friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const iterator& a, const iterator& b) {
+            // the distance is in elements of the span, not in raw memory, so we divide out the stride
+            return (a.ptr - b.ptr) / static_cast<difference_type>(a.stride);
+        }
+
+        friend bool operator==(const iterator& a, const iterator& b) { return a.ptr == b.ptr; }
+        friend bool operator!=(const iterator& a, const iterator& b) { return a.ptr != b.ptr; }
+        friend bool operator<(const iterator& a, const iterator& b) { return a.ptr < b.ptr; }
+        friend bool operator>(const iterator& a, const iterator& b) { return a.ptr > b.ptr; }
+        friend bool operator<=(const iterator& a, const iterator& b) { return a.ptr <= b.ptr; }
+        friend bool operator>=(const iterator& a, const iterator& b) { return a.ptr >= b.ptr; }
+
+    private:
+        T* ptr = nullptr; // the element the iterator currently points to
+        size_t stride = 1; // how far to move in memory for every step
+    };
+
+    /**
+     * @brief Construct a new StridedSpan
+     * @param _ptr pointer to the first element
+     * @param _size the number of elements in the span
+     * @param _stride the distance (in elements) between two neighbouring elements of the span
+     */
+    StridedSpan(T* _ptr, size_t _size, size_t _stride = 1) : ptr(_ptr), count(_size), step(_stride) {}
+
+    /**
+     * Allows a mutable span to be passed where a read-only one is expected
+     */
+    operator StridedSpan<const T>() const { return StridedSpan<const T>(ptr, count, step); }
+
+    /**
+     * Unchecked element access, just like `std::vector::operator[]`
+     * @param i the index of the element inside the span
+     * @return T& reference to the element
+     */
+    T& operator[](size_t i) const { return ptr[i * step]; }
+
+    /**
+     * Checked element access, just like `std::vector::at`
+     * @param i the index of the element inside the span
+     * @return T& reference to the element
+     */
+    T& at(size_t i) const {
+        if (i >= count) { // out of bounds so we throw the same error the vector would have
+            throw std::out_of_range("StridedSpan index out of range.");
+        }
+        return ptr[i * step];
+    }
+
+    size_t size() const { return count; } // the number of elements in the span
+    size_t stride() const { return step; } // the distance in memory between two elements
+    bool empty() const { return count == 0; } // true if the span has no elements
+    bool contiguous() const { return step == 1; } // true if the elements sit next to each other in memory
+    T* data() const { return ptr; } // pointer to the first element
+
+    iterator begin() const { return iterator(ptr, step); }
+    iterator end() const { return iterator(ptr + count * step, step); }
+
+private:
+    T* ptr; // pointer to the first element
+    size_t count; // number of elements in the span
+    size_t step; // distance in memory between two neighbouring elements
+};
+
+/**
+ * A non-owning view over a rectangular block of a row-major matrix.
+ * The block does not need to be the whole matrix, `ld` (the leading dimension) is the length of a
+ * full row in memory so a submatrix can skip over the columns it does not cover
+ * @tparam T the element type; use `const T` for a read-only view
+ */
+template<class T> class TransposedView;
+
+template<class T>
+class MatrixView {
+public:
+    typedef StridedSpan<T> row_t; // type of a single row (or column) of the view
+
+    /**
+     * @brief Construct a new MatrixView
+     * @param _ptr pointer to the top left element
+     * @param _rows the number of rows in the view
+     * @param _cols the number of cols in the view
+     * @param _ld the distance in memory between the start of two rows (defaults to `_cols` i.e. no gaps)
+     */
+    MatrixView(T* _ptr, size_t _rows, size_t _cols, size_t _ld)
+      : ptr(_ptr), rows(_rows), cols(_cols), ld(_ld) {}
+    MatrixView(T* _ptr, size_t _rows, size_t _cols) : MatrixView(_ptr, _rows, _cols, _cols) {}
+
+    /**
+     * Allows a mutable view to be passed where a read-only one is expected
+     */
+    operator MatrixView<const T>() const { return MatrixView<const T>(ptr, rows, cols, ld); }
+
+    size_t numRows() const { return rows; } // number of rows in the view
+    size_t numCols() const { return cols; } // number of cols in the view
+    size_t stride() const { return ld; } // distance in memory between the start of two rows
+    T* data() const { return ptr; } // pointer to the top left element
+
+    /**
+     * Unchecked element access
+     * @param row the row of the element
+     * @param col the col of the element
+     * @return T& reference to the element
+     */
+    T& operator()(size_t row, size_t col) const { return ptr[row * ld + col]; }
+
+    /**
+     * Access operator to get a specific row of the view; allows for double indexing like `view[row][col]`
+     * @param row the row index to access
+     * @return row_t a view of the specified row
+     */
+    row_t operator[](size_t row) const {
+        if (row >= rows) { // keep the bounds checking that `std::vector::at` used to give us
+            throw std::out_of_range("Matrix row index out of range.");
+        }
+        return this->row(row);
+    }
+
+    // unchecked accessors for the different strided slices of the view
+    row_t row(size_t r) const { return row_t(ptr + r * ld, cols, 1); } // a row is contiguous
+    row_t col(size_t c) const { return row_t(ptr + c, rows, ld); } // a col jumps a full row every step
+    row_t diagonal() const { return row_t(ptr, std::min(rows, cols), ld + 1); } // down one row and right one col
+    // down one row and left one col; the start is the top right cell
+    row_t antiDiagonal() const {
+        size_t n = std::min(rows, cols);
+        // a 1x1 view would get a stride of 0 which makes `begin() == end()`, so we give it a stride of 1
+        return row_t(n ? ptr + (cols - 1) : ptr, n, n > 1 ? ld - 1 : 1);
+    }
+
+    /**
+     * Gives a view of a rectangular block inside this view without copying
+     * @param row the first row of the block
+     * @param col the first col of the block
+     * @param nRows the number of rows in the block
+     * @param nCols the number of cols in the block
+     * @return MatrixView the view of the block
+     */
+    MatrixView submatrix(size_t row, size_t col, size_t nRows, size_t nCols) const {
+        if (row + nRows > rows || col + nCols > cols) { // the block has to fit inside the view
+            throw std::out_of_range("Submatrix does not fit inside the matrix.");
+        }
+        return MatrixView(ptr + row * ld + col, nRows, nCols, ld);
+    }
+
+    /**
+     * Gives the transpose of this view without copying; see `TransposedView`
+     * @return TransposedView<T> the view with rows and cols swapped
+     */
+    TransposedView<T> transposed() const { return TransposedView<T>(*this); }
+
+    /**
+     * Trace is the main diagonal sum (top left to bottom right)
+     * @return the sum of the main diagonal cells
+     */
+    std::remove_const_t<T> trace() const {
+        // trace can only be done on a square matrix so we check that it is one
+        if (rows != cols) {
+            throw std::invalid_argument("Trace is only defined for square matrices.");
+        }
+
+        return sum(diagonal()); // walk the diagonal view in place; no copy
+    }
+
+    /**
+     * Calculates the secondary diagonal sum (top right to bottom left)
+     * @return the sum of the secondary diagonal cells
+     */
+    std::remove_const_t<T> secondaryDiagonalSum() const {
+        // same as before; can only be preformed on a square matrix
+        if (rows != cols) {
+            throw std::invalid_argument("Secondary diagonal sum is only defined for square matrices.");
+        }
+
+        return sum(antiDiagonal()); // walk the anti-diagonal view in place; no copy
+    }
+
+    /**
+     * Swaps two rows of the view in place; out of bound indices are ignored
+     * @param row1 the index of the first row
+     * @param row2 the index of the second row
+     */
+    void swapRows(size_t row1, size_t row2) const {
+        static_assert(!std::is_const_v<T>, "Cannot swap rows of a read-only view.");
+        // check if indices are in bound, if not do nothing
+        if (row1 >= rows || row2 >= rows || row1 == row2) return;
+
+        T* a = ptr + row1 * ld; // start of the first row
+        std::swap_ranges(a, a + cols, ptr + row2 * ld); // rows are contiguous so this is a straight memory swap
+    }
+
+    /**
+     * Checks if any cell of the view lies in the memory range [begin, end); used to keep a result from being
+     * written over an operand it still has to read
+     * @param begin the first byte of the range
+     * @param end one past the last byte of the range
+     */
+    bool overlaps(const void* begin, const void* end) const {
+        if (rows == 0 || cols == 0) return false;
+        const void* first = ptr;
+        const void* last = ptr + (rows - 1) * ld + cols; // one past the last cell
+        std::less<const void*> less; // `<` on pointers into different buffers is unspecified, `std::less` is not
+        return less(first, end) && less(begin, last);
+    }
+
+    /**
+     * Swaps two cols of the view in place; out of bound indices are ignored.
+     * Every row costs a cache line or two however it is done, so a tall view is split over threads
+     * (for many swaps on a big matrix use `PermutedMatrix` (matrixPermutation.h), where each swap is O(1))
+     * @param col1 the index of the first col
+     * @param col2 the index of the second col
+     */
+    void swapCols(size_t col1, size_t col2) const {
+        static_assert(!std::is_const_v<T>, "Cannot swap cols of a read-only view.");
+        // check if indices are in bound, if not do nothing
+        if (col1 >= cols || col2 >= cols || col1 == col2) return;
+
+        // each row touches about as much memory as 16 elements of an elementwise op
+        parallelFor(0, rows, std::max<size_t>(1, ThreadPool::minParallelElements / 16), [&](size_t lo, size_t hi) {
+            T* a = ptr + col1;
+            T* b = ptr + col2;
+            for (size_t i = lo; i < hi; i++) std::swap(a[i * ld], b[i * ld]);
+        });
+    }
+
+private:
+    /**
+     * Adds up every element of a strided span; vectorized, and split over threads when the span is very long
+     * (every element of a diagonal is on its own cache line, so a long one is worth spreading out)
+     */
+    static std::remove_const_t<T> sum(row_t span) {
+        typedef std::remove_const_t<T> value_t;
+        MATRIX_PROFILE_SCOPE(Diagonal, span.size() * sizeof(T));
+        const T* p = span.data();
+        const size_t stride = span.stride();
+        value_t total{};
+        std::mutex totalMutex; // guards `total`; only locked once per chunk
+        parallelFor(0, span.size(), ThreadPool::minParallelElements, [&](size_t lo, size_t hi) {
+            value_t part = simd::sum<value_t>(p + lo * stride, hi - lo, stride);
+            std::lock_guard<std::mutex> lock(totalMutex);
+            total += part;
+        });
+        return total;
+    }
+
+    T* ptr; // pointer to the top left element
+    size_t rows, cols; // dimensions of the view
+    size_t ld; // leading dimension; the length of a full row in memory
+};
+
+/**
+ * The transpose of a `MatrixView` without copying: cell (i, j) of this view is cell (j, i) of the one it wraps,
+ * so a row of this view is a (strided) col of the other. Use `transpose`/`transposeInto` (matrix.h) when the result
+ * will be read many times or handed to a kernel that wants row-major data
+ * @tparam T the element type; use `const T` for a read-only view
+ */
+template<class T>
+class TransposedView {
+public:
+    typedef StridedSpan<T> row_t; // type of a single row (or column) of the view
+
+    /**
+     * @brief Construct a new TransposedView
+     * @param _base the view to transpose
+     */
+    explicit TransposedView(MatrixView<T> _base) : base(_base) {}
+
+    /**
+     * Allows a mutable view to be passed where a read-only one is expected
+     */
+    operator TransposedView<const T>() const { return TransposedView<const T>(base); }
+
+    size_t numRows() const { return base.numCols(); } // number of rows in the view
+    size_t numCols() const { return base.numRows(); } // number of cols in the view
+    MatrixView<T> transposed() const { return base; } // the untransposed view; transposing twice is free
+
+    /**
+     * Unchecked element access
+     * @param row the row of the element
+     * @param col the col of the element
+     * @return T& reference to the element
+     */
+    T& operator()(size_t row, size_t col) const { return base(col, row); }
+
+    /**
+     * Access operator to get a specific row of the view; allows for double indexing like `view[row][col]`
+     * @param row the row index to access
+     * @return row_t a view of the specified row
+     */
+    row_t operator[](size_t row) const {
+        if (row >= numRows()) {
+            throw std::out_of_range("Matrix row index out of range.");
+        }
+        return this->row(row);
+    }
+
+    // unchecked accessors; rows and cols of the transpose are cols and rows of the base
+    row_t row(size_t r) const { return base.col(r); }
+    row_t col(size_t c) const { return base.row(c); }
+    row_t diagonal() const { return base.diagonal(); } // the main diagonal does not move
+
+    /**
+     * Gives a view of a rectangular block inside this view without copying
+     * @return TransposedView the view of the block
+     */
+    TransposedView submatrix(size_t row, size_t col, size_t nRows, size_t nCols) const {
+        return TransposedView(base.submatrix(col, row, nCols, nRows));
+    }
+
+    // transposing a square matrix keeps both diagonals as they are (the secondary one is only walked the other way)
+    std::remove_const_t<T> trace() const { return base.trace(); }
+    std::remove_const_t<T> secondaryDiagonalSum() const { return base.secondaryDiagonalSum(); }
+
+    // swapping rows of the transpose swaps cols of the base, and the other way around
+    void swapRows(size_t row1, size_t row2) const { base.swapCols(row1, row2); }
+    void swapCols(size_t col1, size_t col2) const { base.swapRows(col1, col2); }
+
+private:
+    MatrixView<T> base; // the view being transposed
+};
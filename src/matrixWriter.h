@@ -0,0 +1,186 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <charconv> // needed for std::to_chars
+#include <ostream> // needed for std::ostream
+#include <sstream> // needed for the fallback formatter
+#include <string> // needed for std::string
+#include <vector> // needed for the output buffer
+#include <algorithm> // needed for std::max and std::min
+#include <type_traits> // needed to pick the fast path
+#include <optional> // needed to only make the fallback stream when it is used
+
+#include "matrixView.h" // the writer works on views so it does not need the whole Matrix class
+#include "matrixParser.h" // `parse::fastPath`: the types `to_chars` formats the same way `operator<<` does
+#include "matrixProfile.h" // opt-in timing of printing
+
+// how the matrix is laid out as text
+enum class MatrixLayout {
+    Pretty, // `|\t1\t2\t|` per row; what `operator<<` prints
+    Plain, // `1 2` per row; with a `writeSize` line first this is the file format `MatrixReader` reads
+};
+
+/**
+ * Formats matrices into one big reusable buffer with `std::to_chars` and hands it to the stream in a few large writes,
+ * instead of going through `operator<<` (and the stream's locale and sentry machinery) once per element.
+ * Everything still buffered is written out by `flush()` or the destructor.
+ *
+ * The pretty layout prints floating point values the way a default formatted stream does (`%g` with the stream's precision)
+ * and the plain layout prints the shortest text that reads back as the same value. If the stream has any formatting flags set
+ * (e.g. `std::fixed` or `std::hex`), or the type is not a plain number, elements go through `operator<<` as before.
+ * For binary output use `BinaryMatrixWriter` (matrixBinary.h), which writes each matrix with a single call
+ */
+class MatrixWriter {
+public:
+    // the buffer is handed to the stream once it holds this much
+    static constexpr size_t FLUSH_SIZE = size_t(1) << 20; // 1 MiB
+
+    /**
+     * @brief Construct a new MatrixWriter
+     * @param _os where the text goes; must outlive the writer
+     * @param _layout how each matrix is laid out
+     */
+    explicit MatrixWriter(std::ostream& _os, MatrixLayout _layout = MatrixLayout::Pretty)
+      : os(_os), layout(_layout), precision(static_cast<int>(_os.precision())),
+        // `dec` (and `skipws`, which only matters for input) is all a freshly made stream has set
+        defaultFlags((_os.flags() & (std::ios::basefield | std::ios::floatfield | std::ios::showpoint |
+                                     std::ios::showpos | std::ios::showbase | std::ios::uppercase)) == std::ios::dec) {}
+
+    MatrixWriter(const MatrixWriter&) = delete; // two writers sharing a stream would interleave their buffers
+    MatrixWriter& operator=(const MatrixWriter&) = delete;
+
+    ~MatrixWriter() {
+        try { flush(); } catch (...) {} // a destructor must not throw; call `flush()` yourself to see errors
+    }
+
+    /**
+     * Writes the size line of the text file format (`N` on its own line); pair with `MatrixLayout::Plain`
+     * @param n the N of the NxN matrices that follow
+     */
+    void writeSize(size_t n) {
+        reserve(32);
+        put(n, false);
+        buffer[used++] = '\n';
+    }
+
+    /**
+     * Writes one matrix in the writer's layout
+     * @param m the matrix (or any view of one)
+     */
+    template<class T>
+    void write(MatrixView<const T> m) { writeCells(m); }
+
+    template<class T>
+    void write(MatrixView<T> m) { write(MatrixView<const T>(m)); }
+
+    template<class T>
+    void write(TransposedView<T> m) { writeCells(m); }
+
+    // anything with a `view()` (i.e. a `Matrix`)
+    template<class M>
+    auto write(const M& m) -> decltype(m.view(), void()) { write(m.view()); }
+
+    /**
+     * Writes anything with `numRows()`, `numCols()` and a cell accessor `m(i, j)` (e.g. a `PermutedMatrix`) in the writer's layout
+     * @param m the matrix
+     */
+    template<class M>
+    void writeCells(const M& m) {
+        typedef std::remove_cv_t<std::remove_reference_t<decltype(m(0, 0))>> value_t;
+        const bool pretty = layout == MatrixLayout::Pretty;
+        MATRIX_PROFILE_NAMED_SCOPE(profileScope, Print, 0); // the bytes are the text written, added at the end
+        [[maybe_unused]] const size_t startBytes = flushed + used;
+        for (size_t i = 0; i < m.numRows(); i++) {
+            reserve(4);
+            if (pretty) { buffer[used++] = '|'; buffer[used++] = '\t'; } // left border
+            for (size_t j = 0; j < m.numCols(); j++) {
+                if constexpr (parse::fastPath<value_t>) {
+                    if (defaultFlags) put(m(i, j), pretty);
+                    else putStreamed(m(i, j));
+                } else {
+                    putStreamed(m(i, j));
+                }
+                reserve(4);
+                if (pretty) buffer[used++] = '\t';
+                else if (j + 1 < m.numCols()) buffer[used++] = ' ';
+            }
+            if (pretty) buffer[used++] = '|'; // right border
+            buffer[used++] = '\n';
+        }
+        MATRIX_PROFILE_ADD_BYTES(profileScope, flushed + used - startBytes);
+    }
+
+    /**
+     * Hands everything buffered to the stream in one write
+     */
+    void flush() {
+        if (used > 0) os.write(buffer.data(), static_cast<std::streamsize>(used));
+        flushed += used;
+        used = 0;
+    }
+
+private:
+    // largest text one number can take with the fast path (a `long double` at the default precision is well under this)
+    static constexpr size_t MAX_NUMBER = 64;
+
+    // makes room for `n` more characters; flushes once the buffer is full and grows it only as far as `FLUSH_SIZE`
+    void reserve(size_t n) {
+        if (used + n <= buffer.size()) return;
+        if (used >= FLUSH_SIZE) flush();
+        if (used + n > buffer.size()) buffer.resize(std::max(used + n, std::min(buffer.size() * 2 + 256, FLUSH_SIZE + 256)));
+    }
+
+    // formats `value` with `to_chars`; `pretty` picks the stream style over the round trip style for floating point values
+    template<class T>
+    void put(const T& value, bool pretty) {
+        reserve(MAX_NUMBER);
+        char* first = buffer.data() + used;
+        char* last = first + MAX_NUMBER;
+        std::to_chars_result r;
+        if constexpr (std::is_floating_point_v<T>) {
+            if (pretty) r = std::to_chars(first, last, value, std::chars_format::general, precision);
+            else r = std::to_chars(first, last, value);
+        } else {
+            r = std::to_chars(first, last, value);
+        }
+        if (r.ec != std::errc()) { // e.g. a huge precision; let the stream deal with it
+            putStreamed(value);
+            return;
+        }
+        used = static_cast<size_t>(r.ptr - buffer.data());
+    }
+
+    // formats `value` with `operator<<` using the stream's own flags, then copies it into the buffer
+    template<class T>
+    void putStreamed(const T& value) {
+        if (!fallback) fallback.emplace(); // a string stream is not cheap to make so only do it when needed
+        fallback->str(std::string());
+        fallback->copyfmt(os);
+        *fallback << value;
+        const std::string text = fallback->str();
+        reserve(text.size());
+        std::copy(text.begin(), text.end(), buffer.begin() + static_cast<std::ptrdiff_t>(used));
+        used += text.size();
+    }
+
+    std::ostream& os; // where the text goes
+    MatrixLayout layout; // how each matrix is laid out
+    int precision; // the stream's precision when the writer was made
+    bool defaultFlags; // the stream has no formatting flags set, so `to_chars` gives the same text as `operator<<`
+    std::vector<char> buffer; // the text not yet written; grows up to a bit over `FLUSH_SIZE`
+    size_t used = 0; // how much of `buffer` holds text
+    size_t flushed = 0; // how much text has been handed to the stream so far
+    std::optional<std::ostringstream> fallback; // formats the elements `to_chars` cannot
+};
+
+/**
+ * Prints a transposed view the same way `operator<<` prints a `Matrix`, without copying it first
+ * @param os the output stream
+ * @param m the view to output
+ * @return std::ostream& reference to the output stream
+ */
+template<class T>
+std::ostream& operator<<(std::ostream& os, TransposedView<T> m) {
+    MatrixWriter(os, MatrixLayout::Pretty).write(m);
+    return os;
+}
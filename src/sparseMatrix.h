@@ -0,0 +1,268 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <vector> // needed for the CSR arrays
+#include <algorithm> // needed for std::lower_bound and std::rotate
+#include <stdexcept> // needed for throwing errors
+#include <iostream> // needed for printing
+
+#include "matrix.h" // the dense matrix the sparse one works with
+#include "matrixSimd.h" // vectorized row updates for the multiply
+#include "threadPool.h" // splits the multiply over threads
+
+/**
+ * A matrix stored in compressed sparse row (CSR) form: only the nonzero cells are kept, row by row.
+ *   - `values[k]` is the k-th nonzero and `colIndex[k]` its column
+ *   - the nonzeros of row i are `values[rowStart[i] .. rowStart[i + 1])`, sorted by column
+ * Memory is O(rows + nonzeros) instead of O(rows * cols), and multiplying by a dense matrix costs O(nonzeros * cols)
+ * instead of O(rows * cols * inner). It mixes with `Matrix<T>` through the usual operators
+ * (`sparse * dense`, `dense * sparse`, `sparse + dense`, `dense + sparse`), which give back a dense `Matrix<T>`
+ * @tparam T the element type
+ */
+template<class T>
+class SparseMatrix {
+public:
+    typedef T value_type; // the element type
+
+    /**
+     * @brief Construct a new (empty) SparseMatrix; every cell is zero
+     * @param _rows the number of rows
+     * @param _cols the number of cols
+     */
+    SparseMatrix(size_t _rows = 0, size_t _cols = 0) : rows(_rows), cols(_cols), rowStart(1, 0) {}
+
+    /**
+     * @brief Construct a SparseMatrix from a dense one, keeping only the nonzero cells
+     * @param dense the matrix to convert
+     */
+    explicit SparseMatrix(const Matrix<T>& dense) : SparseMatrix(dense.numRows(), dense.numCols()) {
+        for (size_t i = 0; i < rows; i++) appendRow(&dense(i, 0), cols);
+    }
+
+    /**
+     * Converts back to a dense matrix
+     * @return Matrix<T> the same matrix with every cell stored
+     */
+    Matrix<T> toDense() const {
+        Matrix<T> dense(rows, cols); // starts out all zero
+        for (size_t i = 0; i < builtRows(); i++)
+            for (size_t k = rowStart[i]; k < rowStart[i + 1]; k++) dense(i, colIndex[k]) = values[k];
+        return dense;
+    }
+
+    /**
+     * Appends the next row from a dense row of `n` values, keeping only the nonzero ones.
+     * Rows are built top to bottom; rows never appended stay all zero
+     * @param row the row's values
+     * @param n how many values `row` holds; must be `numCols()`
+     */
+    void appendRow(const T* row, size_t n) {
+        if (n != cols) throw std::invalid_argument("Row length does not match the matrix.");
+        if (builtRows() >= rows) throw std::out_of_range("Matrix row index out of range.");
+        for (size_t j = 0; j < n; j++) {
+            if (row[j] != T{}) {
+                colIndex.push_back(j);
+                values.push_back(row[j]);
+            }
+        }
+        rowStart.push_back(values.size());
+    }
+
+    /**
+     * Empties the matrix and gives it new dimensions; keeps the buffers so rebuilding a matrix of the same size does not allocate
+     * @param _rows the number of rows
+     * @param _cols the number of cols
+     */
+    void reset(size_t _rows, size_t _cols) {
+        rows = _rows;
+        cols = _cols;
+        rowStart.assign(1, 0);
+        colIndex.clear();
+        values.clear();
+    }
+
+    // makes room for `n` nonzeros so building the matrix does not keep reallocating
+    void reserve(size_t n) {
+        colIndex.reserve(n);
+        values.reserve(n);
+    }
+
+    size_t numRows() const { return rows; } // the number of rows in the matrix
+    size_t numCols() const { return cols; } // the number of cols in the matrix
+    size_t nonZeros() const { return values.size(); } // the number of stored cells
+    size_t memoryBytes() const { // what the CSR arrays take up (the dense matrix would take `rows * cols * sizeof(T)`)
+        return rowStart.size() * sizeof(size_t) + colIndex.size() * sizeof(size_t) + values.size() * sizeof(T);
+    }
+
+    /**
+     * Gets a cell; O(log nonzeros in the row)
+     * @param row the row index
+     * @param col the col index
+     * @return T the value of the cell (zero if it is not stored)
+     */
+    T operator()(size_t row, size_t col) const {
+        if (row >= builtRows()) return T{};
+        auto first = colIndex.begin() + static_cast<std::ptrdiff_t>(rowStart[row]);
+        auto last = colIndex.begin() + static_cast<std::ptrdiff_t>(rowStart[row + 1]);
+        auto it = std::lower_bound(first, last, col); // the cols of a row are sorted
+        return (it != last && *it == col) ? values[static_cast<size_t>(it - colIndex.begin())] : T{};
+    }
+
+    /**
+     * Trace is the main diagonal sum (top left to bottom right)
+     * @return T the sum of the main diagonal cells
+     */
+    T trace() const {
+        // trace can only be done on a square matrix so we check that it is one
+        if (rows != cols) {
+            throw std::invalid_argument("Trace is only defined for square matrices.");
+        }
+        T sum{};
+        for (size_t i = 0; i < rows; i++) sum += (*this)(i, i);
+        return sum;
+    }
+
+    /**
+     * Calculates the secondary diagonal sum (top right to bottom left)
+     * @return T the sum of the secondary diagonal cells
+     */
+    T secondaryDiagonalSum() const {
+        // same as before; can only be preformed on a square matrix
+        if (rows != cols) {
+            throw std::invalid_argument("Secondary diagonal sum is only defined for square matrices.");
+        }
+        T sum{};
+        for (size_t i = 0; i < rows; i++) sum += (*this)(i, cols - 1 - i);
+        return sum;
+    }
+
+    /**
+     * Swaps two rows of the matrix; out of bound indices are ignored (like `Matrix::swapRows`).
+     * Only the nonzeros between the two rows move, so this is O(nonzeros between them)
+     * @param row1 the index of the first row
+     * @param row2 the index of the second row
+     */
+    void swapRows(size_t row1, size_t row2) {
+        // check if indices are in bound, if not do nothing
+        if (row1 >= rows || row2 >= rows || row1 == row2) return;
+        if (row1 > row2) std::swap(row1, row2);
+        fillRows(); // the row pointers have to cover both rows
+
+        // the block [row1, row2] is laid out as | row1 | middle | row2 |; turn it into | row2 | middle | row1 |
+        const size_t a = rowStart[row1], b = rowStart[row1 + 1], c = rowStart[row2], d = rowStart[row2 + 1];
+        const size_t len1 = b - a, len2 = d - c;
+        swapBlocks(colIndex, a, b, c, d);
+        swapBlocks(values, a, b, c, d);
+
+        // rows in the middle shift by the difference in length, and row1/row2 take each other's sizes
+        for (size_t i = row1 + 1; i <= row2; i++) rowStart[i] = rowStart[i] - len1 + len2;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const SparseMatrix& m) { return os << m.toDense(); }
+
+    // the stored cells of row `row` are `valueData()[rowBegin(row) .. rowEnd(row))`, with their cols at the same spots in `colData()`
+    size_t rowBegin(size_t row) const { return row < builtRows() ? rowStart[row] : values.size(); }
+    size_t rowEnd(size_t row) const { return row < builtRows() ? rowStart[row + 1] : values.size(); }
+    const size_t* colData() const { return colIndex.data(); }
+    const T* valueData() const { return values.data(); }
+
+private:
+    // rows appended so far (the rest are all zero)
+    size_t builtRows() const { return rowStart.size() - 1; }
+
+    // closes off every row not appended yet as empty
+    void fillRows() { rowStart.resize(rows + 1, values.size()); }
+
+    // turns | x[a,b) | x[b,c) | x[c,d) | into | x[c,d) | x[b,c) | x[a,b) | in place
+    template<class V>
+    static void swapBlocks(V& x, size_t a, size_t b, size_t c, size_t d) {
+        auto at = [&](size_t i) { return x.begin() + static_cast<std::ptrdiff_t>(i); };
+        std::rotate(at(a), at(c), at(d)); // | x[c,d) | x[a,b) | x[b,c) |
+        std::rotate(at(a + (d - c)), at(a + (d - c) + (b - a)), at(d)); // | x[c,d) | x[b,c) | x[a,b) |
+    }
+
+    size_t rows, cols; // dimensions of the matrix
+    std::vector<size_t> rowStart; // where each row starts in `values`; one more entry than rows built
+    std::vector<size_t> colIndex; // the col of each stored cell
+    std::vector<T> values; // the stored (nonzero) cells
+};
+
+/**
+ * Multiplication operator (*) => (SparseMatrix<T> * Matrix<T>)
+ * Row i of the result is the sum of `value * dense row col` over the nonzeros of sparse row i, so the work is
+ * O(nonzeros * dense cols) and each step is a vectorized row update
+ * @return Matrix<T> the dense product
+ */
+template<class T>
+Matrix<T> operator*(const SparseMatrix<T>& a, const Matrix<T>& b) {
+    // Matrix multiplication needs the left matrix cols to be equal to the right's row number
+    if (a.numCols() != b.numRows()) {
+        throw std::invalid_argument("Matrix dimensions do not allow multiplication.");
+    }
+    Matrix<T> result(a.numRows(), b.numCols()); // starts out all zero
+    const size_t n = b.numCols();
+    const size_t* cols = a.colData();
+    const T* values = a.valueData();
+    // rows are independent; a grain of rows that together do about `minParallelElements` of work
+    const size_t perRow = std::max<size_t>(1, a.nonZeros() / std::max<size_t>(a.numRows(), 1) * n);
+    parallelFor(0, a.numRows(), std::max<size_t>(1, ThreadPool::minParallelElements / perRow), [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {
+            T* out = &result(i, 0);
+            for (size_t k = a.rowBegin(i); k < a.rowEnd(i); k++) simd::axpy(values[k], &b(cols[k], 0), out, out, n);
+        }
+    });
+    return result;
+}
+
+/**
+ * Multiplication operator (*) => (Matrix<T> * SparseMatrix<T>)
+ * Each dense cell (i, k) scatters into row i of the result along the nonzeros of sparse row k; O(dense rows * nonzeros)
+ * @return Matrix<T> the dense product
+ */
+template<class T>
+Matrix<T> operator*(const Matrix<T>& a, const SparseMatrix<T>& b) {
+    // Matrix multiplication needs the left matrix cols to be equal to the right's row number
+    if (a.numCols() != b.numRows()) {
+        throw std::invalid_argument("Matrix dimensions do not allow multiplication.");
+    }
+    Matrix<T> result(a.numRows(), b.numCols()); // starts out all zero
+    const size_t* cols = b.colData();
+    const T* values = b.valueData();
+    const size_t perRow = std::max<size_t>(1, b.nonZeros());
+    parallelFor(0, a.numRows(), std::max<size_t>(1, ThreadPool::minParallelElements / perRow), [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {
+            T* out = &result(i, 0);
+            for (size_t k = 0; k < a.numCols(); k++) {
+                const T scale = a(i, k);
+                if (scale == T{}) continue;
+                for (size_t p = b.rowBegin(k); p < b.rowEnd(k); p++) out[cols[p]] += scale * values[p];
+            }
+        }
+    });
+    return result;
+}
+
+/**
+ * Addition operator (+) => (SparseMatrix<T> + Matrix<T>); copies the dense matrix and adds the nonzeros onto it
+ * @return Matrix<T> the dense sum
+ */
+template<class T>
+Matrix<T> operator+(const SparseMatrix<T>& a, const Matrix<T>& b) {
+    // Can only add matrices of the same size so we check that we can
+    if (a.numRows() != b.numRows() || a.numCols() != b.numCols()) {
+        throw std::invalid_argument("Matrix dimensions must match for addition.");
+    }
+    Matrix<T> result(b);
+    const size_t* cols = a.colData();
+    const T* values = a.valueData();
+    for (size_t i = 0; i < a.numRows(); i++)
+        for (size_t k = a.rowBegin(i); k < a.rowEnd(i); k++) result(i, cols[k]) += values[k];
+    return result;
+}
+
+/**
+ * Addition operator (+) => (Matrix<T> + SparseMatrix<T>)
+ * @return Matrix<T> the dense sum
+ */
+template<class T>
+Matrix<T> operator+(const Matrix<T>& a, const SparseMatrix<T>& b) { return b + a; }
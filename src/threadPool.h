@@ -0,0 +1,279 @@
+#pragma once // header guard
+
+#include <cstddef> // needed for `size_t`
+#include <cstdlib> // needed for std::getenv and std::strtoul
+#include <vector> // needed to hold the workers and their queues
+#include <thread> // needed for std::thread
+#include <mutex> // needed for std::mutex
+#include <condition_variable> // needed to let idle workers sleep
+#include <atomic> // needed for the job and queue counters
+#include <memory> // needed for std::unique_ptr
+#include <exception> // needed to carry exceptions back to the caller
+#include <algorithm> // needed for std::min
+#include <type_traits> // needed for std::remove_reference_t
+
+/**
+ * A work-stealing thread pool shared by all the matrix kernels.
+ * Every worker has its own queue; it takes work from the back of its own queue and, when that runs dry,
+ * steals from the front of someone else's so a thread that finishes early helps out instead of sitting idle.
+ * The thread that calls `parallelFor` works on its own job too, so a pool of `n` threads only starts `n - 1` workers.
+ *
+ * The thread count comes from the `MATRIX_THREADS` environment variable (or the number of cores if that is not set)
+ * and can be changed at runtime with `ThreadPool::setThreadCount`. Kernels stay serial below their size thresholds
+ * (e.g. the 4x4 matrices in `matrices.txt` never touch the pool)
+ */
+class ThreadPool {
+public:
+    // the thresholds the kernels use to decide if splitting work is worth it; can be tuned at runtime
+    static inline size_t minParallelElements = size_t(1) << 16; // elementwise ops on fewer cells stay serial
+    static inline size_t minParallelFlops = size_t(1) << 21; // multiplies with less work than about 128^3 stay serial
+
+    /**
+     * The shared pool, created on first use
+     * @return ThreadPool& the pool
+     */
+    static ThreadPool& instance() {
+        static ThreadPool pool(defaultThreadCount());
+        return pool;
+    }
+
+    /**
+     * Changes the number of threads the shared pool uses; 1 makes everything run on the calling thread.
+     * Must not be called while a `parallelFor` is running
+     * @param threads the total number of threads, including the caller
+     */
+    static void setThreadCount(size_t threads) { instance().resize(threads); }
+
+    /**
+     * The number of threads the pool starts with: `MATRIX_THREADS` if it is set, else one per core
+     * @return size_t the default thread count (at least 1)
+     */
+    static size_t defaultThreadCount() {
+        if (const char* env = std::getenv("MATRIX_THREADS")) { // the user asked for a specific count
+            size_t n = std::strtoul(env, nullptr, 10);
+            if (n > 0) return n;
+        }
+        size_t cores = std::thread::hardware_concurrency(); // can be 0 if the count is unknown
+        return cores > 0 ? cores : 1;
+    }
+
+    /**
+     * @brief Construct a new ThreadPool
+     * @param threads the total number of threads, including the thread that calls `parallelFor`
+     */
+    explicit ThreadPool(size_t threads) { start(threads); }
+
+    ThreadPool(const ThreadPool&) = delete; // the workers point back at the pool so it cannot be copied
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() { stop(); }
+
+    /**
+     * Stops the current workers and starts a new set
+     * @param threads the total number of threads, including the caller
+     */
+    void resize(size_t threads) {
+        stop();
+        start(threads);
+    }
+
+    // total number of threads that work on a job, including the caller
+    size_t size() const { return workers.size() + 1; }
+
+    /**
+     * Runs `fn(lo, hi)` over sub-ranges that together cover [begin, end) and waits for all of them.
+     * Every sub-range except the last is a multiple of `grain` items long (so e.g. SIMD chunks stay aligned).
+     * Ranges of at most `grain` items (or a pool of one thread) run straight on the calling thread.
+     * If any call throws, the first exception is rethrown here once every range has finished
+     * @param begin the first index
+     * @param end one past the last index
+     * @param grain the smallest range worth handing to another thread
+     * @param fn the work; called as `fn(size_t lo, size_t hi)`
+     */
+    template<class F>
+    void parallelFor(size_t begin, size_t end, size_t grain, F&& fn) {
+        if (end <= begin) return;
+        const size_t n = end - begin;
+        grain = std::max<size_t>(grain, 1);
+        if (size() == 1 || n <= grain) { // not worth splitting
+            fn(begin, end);
+            return;
+        }
+
+        // a few chunks per thread so the stealing can even out chunks that take longer than others
+        const size_t chunks = std::min((n + grain - 1) / grain, size() * 4);
+        const size_t chunk = ((n + chunks - 1) / chunks + grain - 1) / grain * grain; // rounded up to whole grains
+
+        Job job;
+        job.ctx = &fn;
+        job.run = [](void* ctx, size_t lo, size_t hi) { (*static_cast<std::remove_reference_t<F>*>(ctx))(lo, hi); };
+        job.remaining.store((n + chunk - 1) / chunk);
+
+        // deal the chunks out over the queues; the caller's own queue gets the first one so it starts on it right away
+        // (`pending` goes up first so a worker that grabs a chunk straight away cannot take it below zero)
+        const size_t home = currentQueue();
+        pending.fetch_add(job.remaining.load());
+        size_t q = home;
+        for (size_t lo = begin; lo < end; lo += chunk) {
+            queues[q]->push(Task{&job, lo, std::min(end, lo + chunk)});
+            q = (q + 1) % queues.size();
+        }
+        { std::lock_guard<std::mutex> lock(sleepMutex); } // so a worker between its check and its wait cannot miss the notify
+        sleepCv.notify_all();
+
+        // help out until every chunk of our job is done (this may also run chunks of other jobs, which is fine)
+        while (job.remaining.load(std::memory_order_acquire) > 0) {
+            Task task;
+            if (findTask(home, task)) runTask(task);
+            else std::this_thread::yield(); // the last chunks are running on other threads
+        }
+
+        if (job.error) std::rethrow_exception(job.error);
+    }
+
+private:
+    // one call to `parallelFor`; lives on the caller's stack until every chunk is done
+    struct Job {
+        void (*run)(void* ctx, size_t lo, size_t hi) = nullptr; // calls the user's function without a heap allocated wrapper
+        void* ctx = nullptr; // the user's function
+        std::atomic<size_t> remaining{0}; // chunks not finished yet
+        std::mutex errorMutex; // guards `error`
+        std::exception_ptr error; // first exception thrown by a chunk
+    };
+
+    // one chunk of a job
+    struct Task {
+        Job* job = nullptr;
+        size_t lo = 0, hi = 0;
+    };
+
+    /**
+     * A double ended queue of tasks stored in a ring buffer; it only allocates when it grows
+     * so a steady stream of jobs does not touch the heap
+     */
+    class TaskQueue {
+    public:
+        void push(const Task& task) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (count == ring.size()) grow();
+            ring[(head + count) % ring.size()] = task;
+            count++;
+        }
+
+        // the owner works from the back (most recently pushed; likely still in cache)
+        bool popBack(Task& task) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (count == 0) return false;
+            count--;
+            task = ring[(head + count) % ring.size()];
+            return true;
+        }
+
+        // thieves take from the front (oldest) so they do not fight the owner for the same end
+        bool popFront(Task& task) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (count == 0) return false;
+            task = ring[head];
+            head = (head + 1) % ring.size();
+            count--;
+            return true;
+        }
+
+    private:
+        void grow() {
+            std::vector<Task> bigger(std::max<size_t>(16, ring.size() * 2));
+            for (size_t i = 0; i < count; i++) bigger[i] = ring[(head + i) % ring.size()];
+            ring.swap(bigger);
+            head = 0;
+        }
+
+        std::mutex mutex;
+        std::vector<Task> ring;
+        size_t head = 0, count = 0;
+    };
+
+    // which queue the calling thread owns; outside threads all share queue 0
+    size_t currentQueue() const { return workerPool == this ? workerIndex : 0; }
+
+    // looks for work: first our own queue, then everyone else's
+    bool findTask(size_t home, Task& task) {
+        if (queues[home]->popBack(task)) return true;
+        for (size_t i = 1; i < queues.size(); i++) {
+            if (queues[(home + i) % queues.size()]->popFront(task)) return true;
+        }
+        return false;
+    }
+
+    void runTask(const Task& task) {
+        pending.fetch_sub(1);
+        Job* job = task.job;
+        try {
+            job->run(job->ctx, task.lo, task.hi);
+        } catch (...) { // keep the first exception for the caller; the other chunks still have to finish
+            std::lock_guard<std::mutex> lock(job->errorMutex);
+            if (!job->error) job->error = std::current_exception();
+        }
+        job->remaining.fetch_sub(1, std::memory_order_release); // after this the job may be gone; do not touch it again
+    }
+
+    void workerLoop(size_t index) {
+        workerPool = this;
+        workerIndex = index;
+        while (true) {
+            Task task;
+            if (findTask(index, task)) {
+                runTask(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepCv.wait(lock, [&] { return stopping || pending.load() > 0; });
+            if (stopping) return;
+        }
+    }
+
+    void start(size_t threads) {
+        threads = std::max<size_t>(threads, 1);
+        stopping = false;
+        queues.clear();
+        for (size_t i = 0; i < threads; i++) queues.push_back(std::make_unique<TaskQueue>()); // queue 0 is for outside callers
+        for (size_t i = 1; i < threads; i++) workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        sleepCv.notify_all();
+        for (auto& w : workers) w.join();
+        workers.clear();
+    }
+
+    std::vector<std::thread> workers; // the worker threads (the caller is the extra thread)
+    std::vector<std::unique_ptr<TaskQueue>> queues; // one per thread; a mutex cannot move so they live on the heap
+    std::atomic<size_t> pending{0}; // tasks sitting in queues; lets idle workers sleep
+    std::mutex sleepMutex; // guards `stopping` and pairs with `sleepCv`
+    std::condition_variable sleepCv; // idle workers wait on this
+    bool stopping = false; // tells the workers to exit
+
+    // which pool the current thread works for and which queue it owns
+    static inline thread_local ThreadPool* workerPool = nullptr;
+    static inline thread_local size_t workerIndex = 0;
+};
+
+/**
+ * Splits [begin, end) over the shared pool; small ranges run inline without ever starting the pool
+ * @param begin the first index
+ * @param end one past the last index
+ * @param grain the smallest range worth handing to another thread
+ * @param fn the work; called as `fn(size_t lo, size_t hi)`
+ */
+template<class F>
+void parallelFor(size_t begin, size_t end, size_t grain, F&& fn) {
+    if (end <= begin) return;
+    if (end - begin <= grain) { // too small to split; do not even create the pool
+        fn(begin, end);
+        return;
+    }
+    ThreadPool::instance().parallelFor(begin, end, grain, std::forward<F>(fn));
+}
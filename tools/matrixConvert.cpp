@@ -0,0 +1,84 @@
+#include <iostream> // needed for messages
+#include <fstream> // needed to write the text file
+#include <string> // needed for std::string
+#include <stdexcept> // needed for exceptions
+
+#include "matrixBinary.h" // the binary format
+#include "matrixStream.h" // the text reader
+
+/**
+ * Converts matrix files between the text format (`matrices.txt`: a size line `N`, then N rows per matrix)
+ * and the binary format in `matrixBinary.h`. The direction is picked from the input: binary files are turned into text
+ * and anything else is parsed as text.
+ * Usage: matrixConvert.out <input> <output> [int|long|float|double]   (the type is for text input; default int)
+ */
+
+// reads every matrix in a text file and appends it to a new binary file; gives back how many were written
+template<typename T>
+size_t textToBinary(const std::string& in, const std::string& out) {
+    MatrixStream<T> matrices(in);
+    BinaryMatrixWriter<T> writer(out, matrices.size(), matrices.size());
+    for (const Matrix<T>& m : matrices) writer.write(m);
+    writer.close();
+    return writer.count();
+}
+
+// writes every matrix in a binary file out as text; gives back how many were written
+template<typename T>
+size_t binaryToText(const std::string& in, const std::string& out) {
+    MappedMatrixFile<T> matrices(in);
+    if (matrices.numRows() != matrices.numCols()) throw std::runtime_error("The text format only holds square matrices.");
+
+    std::ofstream file(out);
+    if (!file.is_open()) throw std::runtime_error("Could not open file: " + out);
+
+    MatrixWriter writer(file, MatrixLayout::Plain); // floating point values are written so they read back exactly
+    writer.writeSize(matrices.numRows());
+    for (size_t k = 0; k < matrices.size(); k++) writer.write(matrices[k]);
+    writer.flush();
+    if (!file) throw std::runtime_error("Could not write file: " + out);
+    return matrices.size();
+}
+
+// runs the conversion for element type `T`
+template<typename T>
+size_t convert(const std::string& in, const std::string& out, bool binaryInput) {
+    return binaryInput ? binaryToText<T>(in, out) : textToBinary<T>(in, out);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <input> <output> [int|long|float|double]" << std::endl;
+        return 1;
+    }
+    const std::string in = argv[1], out = argv[2];
+
+    try {
+        const bool binaryInput = binfmt::isBinaryFile(in);
+        std::string type = argc > 3 ? argv[3] : "int";
+        if (binaryInput) { // the file says what it holds; `MappedMatrixFile` checks the rest of the header once the type is known
+            const binfmt::Header header = binfmt::readHeader(in);
+            switch (static_cast<binfmt::ElementType>(header.elementType)) {
+                case binfmt::ElementType::Int32: type = "int"; break;
+                case binfmt::ElementType::Int64: type = "long"; break;
+                case binfmt::ElementType::Float32: type = "float"; break;
+                case binfmt::ElementType::Float64: type = "double"; break;
+                default: throw std::runtime_error(std::string("Cannot convert ") + binfmt::elementTypeName(header.elementType) + " to text.");
+            }
+        }
+
+        size_t count;
+        if (type == "int") count = convert<int>(in, out, binaryInput);
+        else if (type == "long") count = convert<long>(in, out, binaryInput);
+        else if (type == "float") count = convert<float>(in, out, binaryInput);
+        else if (type == "double") count = convert<double>(in, out, binaryInput);
+        else throw std::invalid_argument("Unknown element type: " + type);
+
+        std::cout << "Converted " << count << " " << type << " matrices from " << (binaryInput ? "binary" : "text")
+                  << " to " << (binaryInput ? "text" : "binary") << ": " << out << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error converting matrix file: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}